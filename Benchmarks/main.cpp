@@ -0,0 +1,483 @@
+//
+// Created by tim on 18.10.26.
+//
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <list>
+#include <deque>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <cstdlib>
+#include <iomanip>
+#include <thread>
+
+#include "csp_solver.h"
+#include "Portfolio.h"
+#include "ParallelSearch.h"
+#include "Model.h"
+
+/**
+ * Domain independent description of a binary CSP. Is instantiated for each benchmarked domain type
+ */
+struct Instance {
+    struct Edge {
+        std::size_t first;
+        std::size_t second;
+        std::function<bool(const int &, const int &)> predicate;
+    };
+
+    std::string name;
+    std::vector<std::vector<int>> domains;
+    std::vector<Edge> constraints;
+    /// equivalent formulation using csp::AllDifferent. Empty if the instance has none
+    std::vector<std::vector<std::size_t>> allDifferent;
+};
+
+struct Result {
+    std::string benchmark;
+    std::string instance;
+    std::string domain;
+    std::size_t repetitions;
+    double min;
+    double median;
+    double mean;
+    double max;
+};
+
+enum class Format {
+    Json, Csv
+};
+
+struct Config {
+    std::filesystem::path resourceDir = CSP_RESOURCE_DIR;
+    std::size_t repetitions = 10;
+    std::size_t warmup = 2;
+    Format format = Format::Json;
+    std::string filter;
+};
+
+auto readSudoku(const std::filesystem::path &file) -> std::optional<Instance> {
+    std::ifstream input(file);
+    std::vector<int> values;
+    int val = 0;
+    while (input >> val) {
+        if (val < 0 || val > 9) {
+            return {};
+        }
+
+        values.emplace_back(val);
+    }
+
+    if (values.size() != 81) {
+        return {};
+    }
+
+    Instance instance;
+    instance.name = "sudoku/" + file.stem().string();
+    for (int v : values) {
+        instance.domains.emplace_back(v == 0 ? std::vector{1, 2, 3, 4, 5, 6, 7, 8, 9} : std::vector{v});
+    }
+
+    auto sameUnit = [](std::size_t a, std::size_t b) {
+        std::size_t rowA = a / 9, colA = a % 9, rowB = b / 9, colB = b % 9;
+        return rowA == rowB || colA == colB || (rowA / 3 == rowB / 3 && colA / 3 == colB / 3);
+    };
+
+    for (std::size_t a = 0; a < 81; ++a) {
+        for (std::size_t b = a + 1; b < 81; ++b) {
+            if (sameUnit(a, b)) {
+                instance.constraints.push_back({a, b, std::not_equal_to<>()});
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < 9; ++i) {
+        std::vector<std::size_t> row, column, block;
+        for (std::size_t j = 0; j < 9; ++j) {
+            row.emplace_back(9 * i + j);
+            column.emplace_back(9 * j + i);
+            block.emplace_back(9 * (3 * (i / 3) + j / 3) + 3 * (i % 3) + j % 3);
+        }
+
+        instance.allDifferent.emplace_back(std::move(row));
+        instance.allDifferent.emplace_back(std::move(column));
+        instance.allDifferent.emplace_back(std::move(block));
+    }
+
+    return instance;
+}
+
+auto makeQueens(int n) -> Instance {
+    Instance instance;
+    instance.name = "queens/" + std::to_string(n);
+    std::vector<int> rows(static_cast<std::size_t>(n));
+    std::iota(rows.begin(), rows.end(), 0);
+    instance.domains.assign(static_cast<std::size_t>(n), rows);
+    for (int a = 0; a < n; ++a) {
+        for (int b = a + 1; b < n; ++b) {
+            instance.constraints.push_back({static_cast<std::size_t>(a), static_cast<std::size_t>(b),
+                                            [dist = b - a](int rowA, int rowB) {
+                                                return rowA != rowB && std::abs(rowA - rowB) != dist;
+                                            }});
+        }
+    }
+
+    return instance;
+}
+
+/**
+ * Random graph coloring instance with a planted solution (always solvable)
+ */
+auto makeColoring(std::size_t numVars, int numColors, double avgDegree, unsigned int seed) -> Instance {
+    Instance instance;
+    instance.name = "coloring/" + std::to_string(numVars) + "x" + std::to_string(numColors);
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> colorDist(0, numColors - 1);
+    std::vector<int> planted(numVars);
+    for (auto &color : planted) {
+        color = colorDist(rng);
+    }
+
+    std::vector<int> colors(static_cast<std::size_t>(numColors));
+    std::iota(colors.begin(), colors.end(), 0);
+    instance.domains.assign(numVars, colors);
+    std::bernoulli_distribution edgeDist(avgDegree / static_cast<double>(numVars));
+    for (std::size_t a = 0; a < numVars; ++a) {
+        for (std::size_t b = a + 1; b < numVars; ++b) {
+            if (planted[a] != planted[b] && edgeDist(rng)) {
+                instance.constraints.push_back({a, b, std::not_equal_to<>()});
+            }
+        }
+    }
+
+    return instance;
+}
+
+template<typename Setup, typename Run>
+auto measure(const Config &config, Setup &&setup, Run &&run) -> std::vector<double> {
+    std::vector<double> times;
+    times.reserve(config.repetitions);
+    for (std::size_t i = 0; i < config.warmup + config.repetitions; ++i) {
+        setup();
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto stop = std::chrono::steady_clock::now();
+        if (i >= config.warmup) {
+            times.emplace_back(std::chrono::duration<double, std::nano>(stop - start).count());
+        }
+    }
+
+    return times;
+}
+
+/**
+ * Runs all benchmarks on the given instance using variables with the given domain type
+ */
+template<template<typename...> typename Domain>
+void benchmarkInstance(const Instance &instance, const std::string &domainName, const Config &config,
+                       std::vector<Result> &results) {
+    using Var = csp::Variable<int, Domain>;
+    using VarPtr = std::shared_ptr<Var>;
+    auto makeVariables = [&instance]() {
+        std::vector<VarPtr> vars;
+        vars.reserve(instance.domains.size());
+        for (const auto &domain : instance.domains) {
+            vars.emplace_back(std::make_shared<Var>(typename Var::DomainT(domain.begin(), domain.end())));
+        }
+
+        return vars;
+    };
+
+    auto makeConstraints = [&instance](const std::vector<VarPtr> &vars) {
+        std::vector<csp::Constraint<VarPtr>> constraints;
+        constraints.reserve(instance.constraints.size());
+        for (const auto &edge : instance.constraints) {
+            constraints.emplace_back(vars[edge.first], vars[edge.second], edge.predicate);
+        }
+
+        return constraints;
+    };
+
+    auto enabled = [&](const std::string &benchmark) {
+        return config.filter.empty() ||
+               (benchmark + "/" + instance.name + "/" + domainName).find(config.filter) != std::string::npos;
+    };
+
+    auto record = [&](const std::string &benchmark, std::vector<double> times) {
+        std::sort(times.begin(), times.end());
+        double mean = std::accumulate(times.begin(), times.end(), 0.0) / static_cast<double>(times.size());
+        results.push_back({benchmark, instance.name, domainName, times.size(), times.front(), times[times.size() / 2],
+                           mean, times.back()});
+    };
+
+    auto vars = makeVariables();
+    auto constraints = makeConstraints(vars);
+    if (enabled("make_csp")) {
+        std::optional<csp::Csp<VarPtr>> built;
+        record("make_csp", measure(config, [&built]() { built.reset(); }, [&]() {
+            built.emplace(csp::make_csp(vars, constraints));
+        }));
+    }
+
+    auto problem = csp::make_csp(vars, constraints);
+    const auto initial = csp::util::makeCspCheckpoint(problem);
+    auto restore = [&problem, &initial]() { csp::util::restoreCspFromCheckpoint(problem, initial); };
+    if (enabled("ac3")) {
+        record("ac3", measure(config, restore, [&problem]() { csp::util::ac3(problem); }));
+    }
+
+    if (enabled("removeInconsistent")) {
+        record("removeInconsistent", measure(config, restore, [&problem]() {
+            for (const auto &arc : problem.arcs) {
+                csp::util::removeInconsistent(arc);
+            }
+        }));
+    }
+
+    if (enabled("makeCspCheckpoint")) {
+        std::optional<csp::util::CspCheckpoint<Var>> checkpoint;
+        record("makeCspCheckpoint", measure(config, [&checkpoint]() { checkpoint.reset(); }, [&]() {
+            checkpoint.emplace(csp::util::makeCspCheckpoint(problem));
+        }));
+    }
+
+    if (enabled("restoreCspFromCheckpoint")) {
+        record("restoreCspFromCheckpoint", measure(config, []() {}, restore));
+    }
+
+    if (enabled("solve")) {
+        record("solve", measure(config, restore, [&problem]() { csp::solve(problem); }));
+    }
+
+    if (enabled("solve_limits")) {
+        // limits that are never reached, measures the overhead of the checks
+        csp::SolverOptions options;
+        options.limits.deadline = std::chrono::steady_clock::now() + std::chrono::hours(24);
+        options.limits.cancellation.emplace();
+        record("solve_limits", measure(config, restore, [&problem, &options]() {
+            csp::trySolve(problem, csp::strategies::Mrv<VarPtr>(), options);
+        }));
+    }
+
+    if (enabled("solve_ac3rm")) {
+        csp::SolverOptions options;
+        options.propagation = csp::Propagation::Ac3rm;
+        record("solve_ac3rm", measure(config, restore, [&problem, &options]() {
+            csp::solve(problem, csp::strategies::Mrv<VarPtr>(), options);
+        }));
+    }
+
+    if (enabled("solve_incremental_mrv")) {
+        record("solve_incremental_mrv", measure(config, restore, [&problem]() {
+            csp::solve(problem, csp::strategies::IncrementalMrv<VarPtr>());
+        }));
+    }
+
+    if (enabled("solve_dom_wdeg")) {
+        record("solve_dom_wdeg", measure(config, restore, [&problem]() {
+            csp::solve(problem, csp::strategies::DomWdeg<VarPtr>());
+        }));
+    }
+
+    if (enabled("solve_backjumping")) {
+        csp::SolverOptions options;
+        options.backjumping = true;
+        record("solve_backjumping", measure(config, restore, [&problem, &options]() {
+            csp::solve(problem, csp::strategies::DomWdeg<VarPtr>(), options);
+        }));
+    }
+
+    if (enabled("solve_restarts")) {
+        csp::SolverOptions options;
+        options.restarts = csp::Restarts::Luby;
+        record("solve_restarts", measure(config, restore, [&problem, &options]() {
+            csp::solve(problem, csp::strategies::Mrv<VarPtr>(1), csp::strategies::RandomValueOrder(1), options);
+        }));
+    }
+
+    if (enabled("solve_portfolio")) {
+        csp::Portfolio<VarPtr> portfolio;
+        portfolio.add(csp::strategies::Mrv<VarPtr>());
+        portfolio.add(csp::strategies::DomWdeg<VarPtr>());
+        portfolio.add(csp::strategies::Mrv<VarPtr>(1), csp::strategies::RandomValueOrder(1));
+        record("solve_portfolio", measure(config, restore, [&problem, &portfolio]() {
+            portfolio.solve(problem);
+        }));
+    }
+
+    if (enabled("solve_parallel")) {
+        const unsigned int threads = std::max(std::thread::hardware_concurrency(), 2u);
+        record("solve_parallel", measure(config, restore, [&problem, threads]() {
+            csp::solveParallel(problem, threads);
+        }));
+    }
+
+    if (enabled("model_store") || enabled("model_query")) {
+        // a query reuses the structure of the model instead of rebuilding it with make_csp
+        const csp::Model<VarPtr> cspModel(csp::make_csp(vars, constraints));
+        if (enabled("model_store")) {
+            record("model_store", measure(config, []() {}, [&cspModel]() { (void) cspModel.store(); }));
+        }
+
+        if (enabled("model_query")) {
+            auto store = cspModel.store();
+            record("model_query", measure(config, []() {}, [&store]() { store.solve(); }));
+        }
+    }
+
+    if (enabled("solve_lcv")) {
+        record("solve_lcv", measure(config, restore, [&problem]() {
+            csp::solve(problem, csp::strategies::Mrv<VarPtr>(), csp::strategies::LeastConstrainingValue<VarPtr>());
+        }));
+    }
+
+    if (!instance.allDifferent.empty() && enabled("solve_all_different")) {
+        csp::ConstraintSet<VarPtr> globals;
+        for (const auto &group : instance.allDifferent) {
+            std::vector<VarPtr> scope;
+            for (std::size_t var : group) {
+                scope.emplace_back(vars[var]);
+            }
+
+            globals.add(csp::AllDifferent<VarPtr>(std::move(scope)));
+        }
+
+        auto globalProblem = csp::make_csp(vars, std::move(globals));
+        record("solve_all_different", measure(config, restore, [&globalProblem]() {
+            csp::solve(globalProblem);
+        }));
+    }
+
+    if (enabled("solve_table")) {
+        // each binary constraint as table of its allowed pairs
+        csp::ConstraintSet<VarPtr> tables;
+        for (const auto &edge : instance.constraints) {
+            std::vector<std::vector<int>> tuples;
+            for (int a : instance.domains[edge.first]) {
+                for (int b : instance.domains[edge.second]) {
+                    if (edge.predicate(a, b)) {
+                        tuples.push_back({a, b});
+                    }
+                }
+            }
+
+            tables.add(csp::TableConstraint<VarPtr>({vars[edge.first], vars[edge.second]}, tuples));
+        }
+
+        auto tableProblem = csp::make_csp(vars, std::move(tables));
+        record("solve_table", measure(config, restore, [&tableProblem]() {
+            csp::solve(tableProblem);
+        }));
+    }
+}
+
+void printResults(const std::vector<Result> &results, Format format, std::ostream &out) {
+    out << std::fixed << std::setprecision(0);
+    if (format == Format::Csv) {
+        out << "benchmark,instance,domain,repetitions,min_ns,median_ns,mean_ns,max_ns\n";
+        for (const auto &r : results) {
+            out << r.benchmark << ',' << r.instance << ',' << r.domain << ',' << r.repetitions << ',' << r.min << ','
+                << r.median << ',' << r.mean << ',' << r.max << '\n';
+        }
+
+        return;
+    }
+
+    out << "{\n  \"benchmarks\": [";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto &r = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"benchmark\": \"" << r.benchmark << "\", \"instance\": \""
+            << r.instance << "\", \"domain\": \"" << r.domain << "\", \"repetitions\": " << r.repetitions
+            << ", \"min_ns\": " << r.min << ", \"median_ns\": " << r.median << ", \"mean_ns\": " << r.mean
+            << ", \"max_ns\": " << r.max << "}";
+    }
+
+    out << "\n  ]\n}\n";
+}
+
+auto parseArgs(int argc, char **argv) -> Config {
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for argument '" + arg + "'");
+        }
+
+        std::string value = argv[++i];
+        if (arg == "--res") {
+            config.resourceDir = value;
+        } else if (arg == "--repetitions") {
+            config.repetitions = std::max(1ul, std::stoul(value));
+        } else if (arg == "--warmup") {
+            config.warmup = std::stoul(value);
+        } else if (arg == "--format") {
+            if (value != "json" && value != "csv") {
+                throw std::invalid_argument("Format must be 'json' or 'csv'");
+            }
+
+            config.format = value == "csv" ? Format::Csv : Format::Json;
+        } else if (arg == "--filter") {
+            config.filter = value;
+        } else {
+            throw std::invalid_argument("Unknown argument '" + arg + "'");
+        }
+    }
+
+    return config;
+}
+
+int main(int argc, char **argv) {
+    Config config;
+    try {
+        config = parseArgs(argc, argv);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl << "Usage: " << argv[0]
+                  << " [--res <dir>] [--repetitions <n>] [--warmup <n>] [--format json|csv] [--filter <substring>]"
+                  << std::endl;
+        std::exit(1);
+    }
+
+    std::vector<Instance> instances;
+    std::vector<std::filesystem::path> files;
+    if (std::filesystem::is_directory(config.resourceDir)) {
+        for (const auto &entry : std::filesystem::directory_iterator(config.resourceDir)) {
+            if (entry.path().extension() == ".txt") {
+                files.emplace_back(entry.path());
+            }
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+    for (const auto &file : files) {
+        if (auto instance = readSudoku(file)) {
+            instances.emplace_back(std::move(*instance));
+        } else {
+            std::cerr << "Skipping '" << file.string() << "': not a valid sudoku" << std::endl;
+        }
+    }
+
+    instances.emplace_back(makeQueens(8));
+    instances.emplace_back(makeQueens(24));
+    instances.emplace_back(makeColoring(200, 4, 6.0, 42));
+    instances.emplace_back(makeColoring(1000, 5, 8.0, 42));
+
+    std::vector<Result> results;
+    for (const auto &instance : instances) {
+        std::cerr << "Running " << instance.name << std::endl;
+        benchmarkInstance<std::list>(instance, "list", config, results);
+        benchmarkInstance<std::deque>(instance, "deque", config, results);
+        benchmarkInstance<std::vector>(instance, "vector", config, results);
+        benchmarkInstance<csp::Bitset<64>::Domain>(instance, "bitset", config, results);
+    }
+
+    printResults(results, config.format, std::cout);
+}
@@ -0,0 +1,105 @@
+//
+// Created by tim on 18.10.26.
+//
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+#include "TestTypes.h"
+#include "AllDifferent.h"
+#include "Trail.h"
+
+TEST(all_different_test, hall_set) {
+    auto a = std::make_shared<TestVar>(std::list{1, 2});
+    auto b = std::make_shared<TestVar>(std::list{1, 2});
+    auto c = std::make_shared<TestVar>(std::list{1, 2, 3});
+    csp::AllDifferent<VarPtr> allDifferent({a, b, c});
+    csp::util::NoTrail trail;
+    std::vector<std::size_t> changed;
+    EXPECT_TRUE(allDifferent.filter(trail, changed));
+    EXPECT_EQ(changed, std::vector<std::size_t>{2});
+    EXPECT_EQ(c->valueDomain(), std::list{3});
+    EXPECT_EQ(a->valueDomain(), (std::list{1, 2}));
+    EXPECT_EQ(b->valueDomain(), (std::list{1, 2}));
+    changed.clear();
+    EXPECT_TRUE(allDifferent.filter(trail, changed));
+    EXPECT_TRUE(changed.empty());
+}
+
+TEST(all_different_test, alternating_cycle) {
+    auto a = std::make_shared<TestVar>(std::list{1, 2});
+    auto b = std::make_shared<TestVar>(std::list{2, 3});
+    auto c = std::make_shared<TestVar>(std::list{1, 3});
+    auto d = std::make_shared<TestVar>(std::list{1, 2, 3, 4});
+    auto e = std::make_shared<TestVar>(std::list{3, 4, 5});
+    csp::AllDifferent<VarPtr> allDifferent({a, b, c, d, e});
+    csp::util::NoTrail trail;
+    std::vector<std::size_t> changed;
+    EXPECT_TRUE(allDifferent.filter(trail, changed));
+    EXPECT_EQ(changed, (std::vector<std::size_t>{3, 4}));
+    EXPECT_EQ(a->valueDomain(), (std::list{1, 2}));
+    EXPECT_EQ(b->valueDomain(), (std::list{2, 3}));
+    EXPECT_EQ(c->valueDomain(), (std::list{1, 3}));
+    EXPECT_EQ(d->valueDomain(), std::list{4});
+    EXPECT_EQ(e->valueDomain(), std::list{5});
+}
+
+TEST(all_different_test, inconsistent) {
+    auto a = std::make_shared<BitsetVar>(BitsetVar{1, 2});
+    auto b = std::make_shared<BitsetVar>(BitsetVar{1, 2});
+    auto c = std::make_shared<BitsetVar>(BitsetVar{1, 2});
+    csp::AllDifferent<BitsetVarPtr> allDifferent({a, b, c});
+    csp::util::NoTrail trail;
+    std::vector<std::size_t> changed;
+    EXPECT_FALSE(allDifferent.filter(trail, changed));
+    a->setValueDomain(BitsetVar::DomainT{1, 3});
+    EXPECT_TRUE(allDifferent.filter(trail, changed));
+    EXPECT_EQ(a->valueDomain(), BitsetVar::DomainT{3});
+}
+
+TEST(all_different_test, trail) {
+    auto a = std::make_shared<BitsetVar>(BitsetVar{1});
+    auto b = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3});
+    auto c = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3});
+    std::array vars{a, b, c};
+    csp::AllDifferent<BitsetVarPtr> allDifferent(vars.begin(), vars.end());
+    struct Problem {
+        std::vector<BitsetVarPtr> variables;
+    } problem{{a, b, c}};
+    csp::util::Trail<BitsetVarPtr> trail(problem);
+    trail.push();
+    std::vector<std::size_t> changed;
+    EXPECT_TRUE(allDifferent.filter(trail, changed));
+    EXPECT_EQ(b->valueDomain(), (BitsetVar::DomainT{2, 3}));
+    EXPECT_EQ(trail.size(), 2);
+    trail.pop();
+    EXPECT_EQ(b->valueDomain(), (BitsetVar::DomainT{1, 2, 3}));
+    EXPECT_EQ(c->valueDomain(), (BitsetVar::DomainT{1, 2, 3}));
+}
+
+TEST(all_different_test, long_paths) {
+    // matching the last variable shifts all other variables and all vertices form one component
+    constexpr int N = 100000;
+    std::vector<VarPtr> vars;
+    for (int i = 0; i < N - 1; ++i) {
+        vars.emplace_back(std::make_shared<TestVar>(std::list{i, i + 1}));
+    }
+
+    vars.emplace_back(std::make_shared<TestVar>(std::list{0, N - 1}));
+    csp::AllDifferent<VarPtr> allDifferent(vars);
+    csp::util::NoTrail trail;
+    std::vector<std::size_t> changed;
+    EXPECT_TRUE(allDifferent.filter(trail, changed));
+    EXPECT_TRUE(changed.empty());
+    vars.front()->setValueDomain({1});
+    EXPECT_TRUE(allDifferent.filter(trail, changed));
+    EXPECT_EQ(changed.size(), N - 1);
+    EXPECT_EQ(vars[N - 2]->valueDomain(), std::list{N - 1});
+    EXPECT_EQ(vars.back()->valueDomain(), std::list{0});
+}
+
+TEST(all_different_test, satisfied) {
+    EXPECT_TRUE(csp::AllDifferent<VarPtr>::satisfied({3, 1, 2}));
+    EXPECT_FALSE(csp::AllDifferent<VarPtr>::satisfied({3, 1, 3}));
+}
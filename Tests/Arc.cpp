@@ -46,3 +46,25 @@ TEST(arc_test, create_arcs_from_constraint) {
     EXPECT_EQ(varA, bGreaterA.to());
     EXPECT_EQ(varB, bGreaterA.from());
 }
+
+TEST(arc_test, typed_predicate) {
+    auto varA = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto varB = std::make_shared<TestVar>(std::list{1, 2, 3});
+    csp::Constraint<VarPtr, std::less<>> test(varA, varB, std::less<>());
+    auto [aLessB, bGreaterA] = test.getArcs();
+    static_assert(std::is_same_v<decltype(aLessB), csp::Arc<VarPtr, std::less<>>>);
+    EXPECT_TRUE(aLessB.constraintSatisfied(1, 2));
+    EXPECT_FALSE(aLessB.constraintSatisfied(2, 1));
+    EXPECT_TRUE(bGreaterA.isReversed());
+    EXPECT_TRUE(bGreaterA.constraintSatisfied(2, 1));
+    EXPECT_FALSE(bGreaterA.constraintSatisfied(1, 2));
+}
+
+TEST(arc_test, deduction_uses_binary_predicate) {
+    auto varA = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto varB = std::make_shared<TestVar>(std::list{1, 2, 3});
+    csp::Constraint constraint(varA, varB, std::less<>());
+    csp::Arc arc(varA, varB, [](int a, int b) { return a == b; });
+    static_assert(std::is_same_v<decltype(constraint), TestConstraint>);
+    static_assert(std::is_same_v<decltype(arc), TestArc>);
+}
@@ -0,0 +1,39 @@
+//
+// Created by tim on 18.10.26.
+//
+
+#include <gtest/gtest.h>
+
+#include "ArcQueue.h"
+
+TEST(arc_queue_test, fifo_without_duplicates) {
+    csp::util::ArcQueue queue(4);
+    EXPECT_TRUE(queue.empty());
+    queue.push(2);
+    queue.push(0);
+    queue.push(2);
+    EXPECT_EQ(queue.size(), 2);
+    EXPECT_TRUE(queue.contains(2));
+    EXPECT_EQ(queue.pop(), 2);
+    EXPECT_FALSE(queue.contains(2));
+    queue.push(2);
+    queue.push(3);
+    queue.push(1);
+    EXPECT_EQ(queue.size(), 4);
+    EXPECT_EQ(queue.pop(), 0);
+    EXPECT_EQ(queue.pop(), 2);
+    EXPECT_EQ(queue.pop(), 3);
+    EXPECT_EQ(queue.pop(), 1);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(arc_queue_test, push_all_and_clear) {
+    csp::util::ArcQueue queue(3);
+    queue.pushAll();
+    EXPECT_EQ(queue.size(), 3);
+    queue.clear();
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.contains(1));
+    queue.push(1);
+    EXPECT_EQ(queue.pop(), 1);
+}
@@ -0,0 +1,78 @@
+//
+// Created by tim on 18.10.26.
+//
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+#include "TestTypes.h"
+#include "csp_solver.h"
+
+using Domain = csp::BitsetDomain<int, 70>;
+
+TEST(bitset_domain_test, ctor) {
+    Domain d{5, 1, 69, 1};
+    EXPECT_EQ(d.size(), 3);
+    EXPECT_FALSE(d.empty());
+    EXPECT_EQ(d.front(), 1);
+    EXPECT_EQ(std::vector<int>(d.begin(), d.end()), (std::vector{1, 5, 69}));
+    EXPECT_TRUE(Domain{}.empty());
+    EXPECT_EQ(Domain::full().size(), 70);
+}
+
+TEST(bitset_domain_test, erase) {
+    Domain d{0, 3, 64, 65};
+    EXPECT_TRUE(d.erase(64));
+    EXPECT_FALSE(d.erase(64));
+    EXPECT_FALSE(d.erase(100));
+    auto it = d.erase(d.begin());
+    EXPECT_EQ(*it, 3);
+    EXPECT_EQ(d, (Domain{3, 65}));
+    d.clear();
+    EXPECT_TRUE(d.empty());
+}
+
+TEST(bitset_domain_test, intersect) {
+    Domain d{1, 2, 66};
+    EXPECT_FALSE(d.intersect(Domain{1, 2, 3, 66}));
+    EXPECT_TRUE(d.intersects(Domain{66}));
+    EXPECT_FALSE(d.intersects(Domain{3, 67}));
+    EXPECT_TRUE(d.intersect(Domain{2, 67}));
+    EXPECT_EQ(d, Domain{2});
+}
+
+TEST(bitset_domain_test, variable) {
+    BitsetVar a{1, 2, 3};
+    EXPECT_FALSE(a.isAssigned());
+    a.assign(2);
+    EXPECT_TRUE(a.isAssigned());
+    EXPECT_EQ(a.valueDomain().front(), 2);
+    a.setValueDomain(std::array{4, 5, 6});
+    EXPECT_EQ(a.valueDomain(), (csp::BitsetDomain<int, 16>{4, 5, 6}));
+}
+
+TEST(bitset_domain_test, remove_inconsistent) {
+    auto varA = std::make_shared<BitsetVar>(BitsetVar{2, 3, 1});
+    auto varB = std::make_shared<BitsetVar>(BitsetVar{2, 3, 1});
+    csp::Arc<BitsetVarPtr> a(varA, varB, std::less<>());
+    EXPECT_TRUE(csp::util::removeInconsistent(a));
+    EXPECT_FALSE(csp::util::removeInconsistent(a));
+    EXPECT_EQ(varA->valueDomain(), (csp::BitsetDomain<int, 16>{1, 2}));
+    a.reverse();
+    EXPECT_TRUE(csp::util::removeInconsistent(a));
+    EXPECT_EQ(varB->valueDomain(), (csp::BitsetDomain<int, 16>{2, 3}));
+}
+
+TEST(bitset_domain_test, solve) {
+    auto varA = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3});
+    auto varB = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3});
+    auto varC = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3});
+    BitsetConstraint aLessB(varA, varB, std::less<>());
+    BitsetConstraint bLessC(varB, varC, std::less<>());
+    auto problem = csp::make_csp(std::array{varA, varB, varC}, std::array{aLessB, bLessC});
+    EXPECT_TRUE(csp::solve(problem));
+    EXPECT_EQ(varA->valueDomain().front(), 1);
+    EXPECT_EQ(varB->valueDomain().front(), 2);
+    EXPECT_EQ(varC->valueDomain().front(), 3);
+}
@@ -3,9 +3,13 @@
 //
 
 #include <gtest/gtest.h>
+#include <type_traits>
 
 #include "Csp.h"
+#include "AllDifferent.h"
+#include "NaryConstraint.h"
 #include "TestTypes.h"
+#include "util.h"
 
 void verifyCsp(csp::Csp<VarPtr> &problem, const VarPtr& varA, const VarPtr& varB, const VarPtr& varC) {
     EXPECT_EQ(problem.variables[0], varA);
@@ -15,12 +19,11 @@ void verifyCsp(csp::Csp<VarPtr> &problem, const VarPtr& varA, const VarPtr& varB
     auto arcsCopy = problem.arcs;
 
     auto testArcsPerVar = [&problem, &arcsCopy] (const VarPtr &var) {
-        const auto arcEntry = problem.incomingNeighbours.find(var);
-        EXPECT_NE(arcEntry, problem.incomingNeighbours.end());
-        const auto &incomingArcs = arcEntry->second;
+        const auto incomingArcs = problem.incomingArcs(problem.varIds.at(var));
         EXPECT_EQ(incomingArcs.size(), 2);
-        EXPECT_NE(incomingArcs[0].from(), incomingArcs[1].from());
-        for (const auto &arc : incomingArcs) {
+        EXPECT_NE(problem.arcs[incomingArcs[0]].from(), problem.arcs[incomingArcs[1]].from());
+        for (std::size_t arcId : incomingArcs) {
+            const auto &arc = problem.arcs[arcId];
             EXPECT_EQ(arc.to(), var);
             EXPECT_NE(arc.from(), var);
             auto it = std::find_if(arcsCopy.begin(), arcsCopy.end(), [&arc](const TestArc &t) {
@@ -68,3 +71,125 @@ TEST(csp_test, create_csp_from_arcs) {
     verifyCsp(problem, varA, varB, varC);
 
 }
+
+TEST(csp_test, index_representation) {
+    using namespace csp;
+    auto varA = std::make_shared<TestVar>(std::list{1, 2});
+    auto varB = std::make_shared<TestVar>(std::list{1, 2});
+    auto varC = std::make_shared<TestVar>(std::list{1, 2});
+    Csp problem = make_csp(std::array{varA, varB, varC},
+                           std::array{TestConstraint(varA, varB, std::less<>()),
+                                      TestConstraint(varC, varB, std::less<>())});
+    EXPECT_EQ(problem.varIds.at(varC), 2);
+    ASSERT_EQ(problem.arcSources.size(), problem.arcs.size());
+    for (std::size_t i = 0; i < problem.arcs.size(); ++i) {
+        EXPECT_EQ(problem.variables[problem.arcSources[i]], problem.arcs[i].from());
+        EXPECT_EQ(problem.variables[problem.arcTargets[i]], problem.arcs[i].to());
+    }
+
+    EXPECT_EQ(problem.incomingOffsets, (std::vector<std::size_t>{0, 1, 3, 4}));
+    EXPECT_EQ(problem.incomingArcIds.size(), problem.arcs.size());
+    EXPECT_EQ(problem.incomingArcs(0).size(), 1);
+    EXPECT_EQ(problem.incomingArcs(1).size(), 2);
+    EXPECT_EQ(problem.incomingArcs(2).size(), 1);
+    for (std::size_t arc : problem.incomingArcs(1)) {
+        EXPECT_EQ(problem.arcs[arc].to(), varB);
+    }
+}
+
+TEST(csp_test, unknown_variable) {
+    auto varA = std::make_shared<TestVar>(std::list{1, 2});
+    auto varB = std::make_shared<TestVar>(std::list{1, 2});
+    EXPECT_THROW(csp::make_csp(std::array{varA}, std::array{TestConstraint(varA, varB, std::less<>())}),
+                 std::invalid_argument);
+}
+
+TEST(csp_test, global_constraints) {
+    auto a = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto b = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto c = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto d = std::make_shared<TestVar>(std::list{1, 2, 3});
+    csp::ConstraintSet<VarPtr> constraints;
+    constraints.add(csp::AllDifferent<VarPtr>({c, a, b}));
+    constraints.add(csp::AllDifferent<VarPtr>({b, c}));
+    constraints.emplace(a, d, std::less<>());
+    EXPECT_EQ(constraints.size(), 3);
+    auto problem = csp::make_csp(std::array{a, b, c, d}, constraints);
+    EXPECT_EQ(problem.arcs.size(), 2);
+    EXPECT_EQ(problem.globalConstraints.size(), 2);
+    EXPECT_EQ(problem.queueSize(), 4);
+    auto scope = problem.scope(0);
+    EXPECT_EQ(std::vector(scope.begin(), scope.end()), (std::vector<std::size_t>{2, 0, 1}));
+    scope = problem.scope(1);
+    EXPECT_EQ(std::vector(scope.begin(), scope.end()), (std::vector<std::size_t>{1, 2}));
+    EXPECT_EQ(problem.globalsOf(0).size(), 1);
+    EXPECT_EQ(problem.globalsOf(1).size(), 2);
+    EXPECT_EQ(problem.globalsOf(2).size(), 2);
+    EXPECT_TRUE(problem.globalsOf(3).empty());
+    auto other = std::make_shared<TestVar>(std::list{1});
+    constraints.add(csp::AllDifferent<VarPtr>({a, other}));
+    EXPECT_THROW(csp::make_csp(std::array{a, b, c, d}, constraints), std::invalid_argument);
+}
+
+namespace {
+    struct FixedConstraint {
+        std::vector<VarPtr> vars;
+        [[nodiscard]] auto variables() const noexcept -> const std::vector<VarPtr> & {
+            return vars;
+        }
+
+        template<typename TrailT>
+        bool filter(TrailT &, std::vector<std::size_t> &) {
+            return true;
+        }
+    };
+}
+
+TEST(csp_test, clone) {
+    auto a = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto b = std::make_shared<TestVar>(std::list{1, 2});
+    auto c = std::make_shared<TestVar>(std::list{1, 2});
+    csp::ConstraintSet<VarPtr> constraints;
+    constraints.add(csp::AllDifferent<VarPtr>({a, b, c}));
+    constraints.emplace(b, c, std::less<>());
+    auto problem = csp::make_csp(std::array{a, b, c}, constraints);
+    auto copy = csp::clone(problem);
+    ASSERT_EQ(copy.variables.size(), 3);
+    ASSERT_EQ(copy.arcs.size(), 2);
+    ASSERT_EQ(copy.globalConstraints.size(), 1);
+    for (std::size_t i = 0; i < 3; ++i) {
+        EXPECT_NE(copy.variables[i], problem.variables[i]);
+        EXPECT_EQ(copy.variables[i]->valueDomain(), problem.variables[i]->valueDomain());
+        EXPECT_EQ(copy.varIds.at(copy.variables[i]), i);
+    }
+
+    for (std::size_t i = 0; i < copy.arcs.size(); ++i) {
+        EXPECT_EQ(copy.arcs[i].from(), copy.variables[copy.arcSources[i]]);
+        EXPECT_EQ(copy.arcs[i].to(), copy.variables[copy.arcTargets[i]]);
+        EXPECT_EQ(copy.arcs[i].isReversed(), problem.arcs[i].isReversed());
+    }
+
+    EXPECT_EQ(copy.globalConstraints.front().variables(), copy.variables);
+    // the structure of the problem is shared
+    EXPECT_EQ(&copy.arcSources, &problem.arcSources);
+    EXPECT_EQ(&copy.incomingArcIds, &problem.incomingArcIds);
+    EXPECT_EQ(&copy.scopeVarIds, &problem.scopeVarIds);
+    EXPECT_EQ(&copy.arcRevisers, &problem.arcRevisers);
+    ASSERT_TRUE(csp::util::ac3(copy));
+    EXPECT_EQ(copy.variables[0]->valueDomain(), std::list{3});
+    EXPECT_EQ(copy.variables[1]->valueDomain(), std::list{1});
+    EXPECT_EQ(copy.variables[2]->valueDomain(), std::list{2});
+    EXPECT_EQ(a->valueDomain(), (std::list{1, 2, 3}));
+    EXPECT_EQ(b->valueDomain(), (std::list{1, 2}));
+    EXPECT_EQ(c->valueDomain(), (std::list{1, 2}));
+
+    // constraints without replaceVariables cannot be copied
+    EXPECT_TRUE(csp::type_traits::is_cloneable_global_constraint<csp::AllDifferent<VarPtr>>::value);
+    EXPECT_FALSE(csp::type_traits::is_cloneable_global_constraint<FixedConstraint>::value);
+    constraints.add(FixedConstraint{{a, b}});
+    auto fixed = csp::make_csp(std::array{a, b, c}, constraints);
+    EXPECT_THROW(csp::clone(fixed), std::invalid_argument);
+    // copies would share the state of the global constraints
+    EXPECT_FALSE(std::is_copy_constructible_v<csp::Csp<VarPtr>>);
+    EXPECT_TRUE(std::is_move_constructible_v<csp::Csp<VarPtr>>);
+}
@@ -0,0 +1,136 @@
+//
+// Created by tim on 18.10.26.
+//
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+#include <array>
+#include <thread>
+#include <stdexcept>
+
+#include "TestTypes.h"
+#include "TestProblems.h"
+#include "Model.h"
+#include "TableConstraint.h"
+
+namespace {
+    bool validQueens(const csp::Csp<VarPtr> &problem) {
+        for (std::size_t i = 0; i < problem.variables.size(); ++i) {
+            if (problem.variables[i]->valueDomain().size() != 1) {
+                return false;
+            }
+
+            for (std::size_t j = 0; j < i; ++j) {
+                const int a = problem.variables[j]->valueDomain().front();
+                const int b = problem.variables[i]->valueDomain().front();
+                if (a == b || std::abs(a - b) == static_cast<int>(i - j)) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    struct FixedConstraint {
+        std::vector<VarPtr> vars;
+        [[nodiscard]] auto variables() const noexcept -> const std::vector<VarPtr> & {
+            return vars;
+        }
+
+        template<typename TrailT>
+        bool filter(TrailT &, std::vector<std::size_t> &) {
+            return true;
+        }
+    };
+}
+
+TEST(model_test, queries) {
+    const csp::Model<VarPtr> model(makeQueens(8).first);
+    auto store = model.store();
+    using AssumptionT = csp::DomainStore<VarPtr>::AssumptionT;
+    for (int column = 0; column < 8; ++column) {
+        const std::array assumptions{AssumptionT{0, column}};
+        ASSERT_EQ(store.solve(assumptions), csp::SolveResult::Solved);
+        EXPECT_TRUE(validQueens(store.problem()));
+        EXPECT_EQ(store.problem().variables.front()->valueDomain().front(), column);
+    }
+
+    const std::array conflicting{AssumptionT{0, 0}, AssumptionT{1, 1}};
+    EXPECT_EQ(store.solve(conflicting), csp::SolveResult::Unsatisfiable);
+    const std::array outsideDomain{AssumptionT{3, 8}};
+    EXPECT_EQ(store.solve(outsideDomain), csp::SolveResult::Unsatisfiable);
+    const std::array unknownVariable{AssumptionT{8, 0}};
+    EXPECT_THROW(store.solve(unknownVariable), std::out_of_range);
+    csp::SolveStats stats;
+    EXPECT_EQ(store.solve({}, csp::strategies::DomWdeg<VarPtr>(), csp::strategies::DomainOrder(), {}, stats),
+              csp::SolveResult::Solved);
+    EXPECT_TRUE(validQueens(store.problem()));
+    EXPECT_GT(stats.nodes, 0);
+    store.reset();
+    EXPECT_EQ(store.problem().variables.front()->valueDomain().size(), 8);
+    // the structure of the model is not copied
+    EXPECT_EQ(&store.problem().incomingArcIds, &model.csp().incomingArcIds);
+    EXPECT_NE(store.problem().variables.front(), model.csp().variables.front());
+    for (const auto &var : model.csp().variables) {
+        EXPECT_EQ(var->valueDomain().size(), 8);
+    }
+}
+
+TEST(model_test, global_constraints) {
+    auto a = std::make_shared<TestVar>(std::list{0, 1, 2});
+    auto b = std::make_shared<TestVar>(std::list{0, 1, 2});
+    auto c = std::make_shared<TestVar>(std::list{0, 1, 2});
+    csp::ConstraintSet<VarPtr> constraints;
+    constraints.add(csp::TableConstraint<VarPtr>({a, b, c}, {{0, 1, 2}, {1, 1, 1}, {2, 0, 1}}));
+    constraints.emplace(a, c, std::less<>());
+    const csp::Model<VarPtr> model(csp::make_csp(std::array{a, b, c}, constraints));
+    auto store = model.store();
+    using AssumptionT = csp::DomainStore<VarPtr>::AssumptionT;
+    // the valid tuples of the table are reset for each query
+    const std::array none{AssumptionT{1, 0}};
+    EXPECT_EQ(store.solve(none), csp::SolveResult::Unsatisfiable);
+    const std::array first{AssumptionT{0, 0}};
+    ASSERT_EQ(store.solve(first), csp::SolveResult::Solved);
+    EXPECT_EQ(store.problem().variables[2]->valueDomain(), std::list{2});
+    EXPECT_EQ(store.solve(none), csp::SolveResult::Unsatisfiable);
+
+    constraints.add(FixedConstraint{{a, b}});
+    EXPECT_THROW(csp::Model<VarPtr>(csp::make_csp(std::array{a, b, c}, constraints)), std::invalid_argument);
+}
+
+TEST(model_test, concurrent_stores) {
+    const csp::Model<VarPtr> model(makeQueens(10).first);
+    using AssumptionT = csp::DomainStore<VarPtr>::AssumptionT;
+    auto countSolved = [&model](std::size_t queen) {
+        auto store = model.store();
+        int ret = 0;
+        for (int column = 0; column < 10; ++column) {
+            const std::array assumptions{AssumptionT{queen, column}};
+            if (store.solve(assumptions) == csp::SolveResult::Solved && validQueens(store.problem()) &&
+                store.problem().variables[queen]->valueDomain().front() == column) {
+                ++ret;
+            }
+        }
+
+        return ret;
+    };
+
+    std::vector<int> expected, solved(4, 0);
+    for (std::size_t queen = 0; queen < solved.size(); ++queen) {
+        expected.emplace_back(countSolved(queen));
+    }
+
+    std::vector<std::thread> threads;
+    for (std::size_t queen = 0; queen < solved.size(); ++queen) {
+        threads.emplace_back([&countSolved, &solved, queen]() { solved[queen] = countSolved(queen); });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(solved, expected);
+    EXPECT_GT(expected.front(), 0);
+}
@@ -0,0 +1,129 @@
+//
+// Created by tim on 18.10.26.
+//
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <numeric>
+#include <vector>
+#include <span>
+
+#include "TestTypes.h"
+#include "NaryConstraint.h"
+#include "Trail.h"
+
+auto sumEquals(int sum) {
+    return [sum](std::span<const int> values) { return std::accumulate(values.begin(), values.end(), 0) == sum; };
+}
+
+TEST(nary_constraint_test, gac) {
+    auto a = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto b = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto c = std::make_shared<TestVar>(std::list{1, 2, 3});
+    csp::NaryConstraint sum(std::vector{a, b, c}, sumEquals(8));
+    csp::util::NoTrail trail;
+    std::vector<std::size_t> changed;
+    EXPECT_TRUE(sum.filter(trail, changed));
+    EXPECT_EQ(changed, (std::vector<std::size_t>{0, 1, 2}));
+    EXPECT_EQ(a->valueDomain(), (std::list{2, 3}));
+    EXPECT_EQ(b->valueDomain(), (std::list{2, 3}));
+    EXPECT_EQ(c->valueDomain(), (std::list{2, 3}));
+    a->assign(2);
+    changed.clear();
+    EXPECT_TRUE(sum.filter(trail, changed));
+    EXPECT_EQ(changed, (std::vector<std::size_t>{1, 2}));
+    EXPECT_EQ(b->valueDomain(), std::list{3});
+    EXPECT_EQ(c->valueDomain(), std::list{3});
+    EXPECT_TRUE(sum.satisfied(std::vector{2, 3, 3}));
+}
+
+TEST(nary_constraint_test, inconsistent) {
+    auto a = std::make_shared<BitsetVar>(BitsetVar{1, 2});
+    auto b = std::make_shared<BitsetVar>(BitsetVar{1, 2});
+    csp::NaryConstraint sum(std::vector{a, b}, sumEquals(5));
+    csp::util::NoTrail trail;
+    std::vector<std::size_t> changed;
+    EXPECT_FALSE(sum.filter(trail, changed));
+}
+
+TEST(nary_constraint_test, trail) {
+    auto a = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3});
+    auto b = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3});
+    csp::NaryConstraint sum(std::vector{a, b}, sumEquals(5));
+    struct Problem {
+        std::vector<BitsetVarPtr> variables;
+    } problem{{a, b}};
+    csp::util::Trail<BitsetVarPtr> trail(problem);
+    trail.push();
+    std::vector<std::size_t> changed;
+    EXPECT_TRUE(sum.filter(trail, changed));
+    EXPECT_EQ(a->valueDomain(), (BitsetVar::DomainT{2, 3}));
+    trail.pop();
+    EXPECT_EQ(a->valueDomain(), (BitsetVar::DomainT{1, 2, 3}));
+    EXPECT_EQ(b->valueDomain(), (BitsetVar::DomainT{1, 2, 3}));
+}
+
+TEST(nary_constraint_test, new_values) {
+    auto a = std::make_shared<TestVar>(std::list{1, 2});
+    auto b = std::make_shared<TestVar>(std::list{1, 2, 3});
+    csp::NaryConstraint sum(std::vector{a, b}, sumEquals(5));
+    csp::util::NoTrail trail;
+    std::vector<std::size_t> changed;
+    EXPECT_TRUE(sum.filter(trail, changed));
+    EXPECT_EQ(b->valueDomain(), std::list{3});
+    // values that were not in the domain during the first filter get their own residues
+    a->setValueDomain({1, 2, 4});
+    b->setValueDomain({1, 3, 4, 5});
+    changed.clear();
+    EXPECT_TRUE(sum.filter(trail, changed));
+    EXPECT_EQ(changed, std::vector<std::size_t>{1});
+    EXPECT_EQ(a->valueDomain(), (std::list{1, 2, 4}));
+    EXPECT_EQ(b->valueDomain(), (std::list{1, 3, 4}));
+}
+
+TEST(nary_constraint_test, callback) {
+    auto a = std::make_shared<TestVar>(std::list{1, 2, 3, 4});
+    auto b = std::make_shared<TestVar>(std::list{2, 3, 4});
+    auto c = std::make_shared<TestVar>(std::list{0, 1, 2});
+    // capacity: a + b + c <= 5
+    csp::CallbackConstraint capacity(std::vector{a, b, c}, [](const auto &vars, auto &&remove) {
+        int minSum = 0;
+        for (const auto &var : vars) {
+            minSum += *std::min_element(var->valueDomain().begin(), var->valueDomain().end());
+        }
+
+        if (minSum > 5) {
+            return false;
+        }
+
+        for (std::size_t pos = 0; pos < vars.size(); ++pos) {
+            const auto &domain = vars[pos]->valueDomain();
+            const int slack = 5 - minSum + *std::min_element(domain.begin(), domain.end());
+            std::vector<int> tooLarge;
+            std::copy_if(domain.begin(), domain.end(), std::back_inserter(tooLarge), [slack](int v) {
+                return v > slack;
+            });
+
+            for (int val : tooLarge) {
+                remove(pos, val);
+            }
+        }
+
+        return true;
+    });
+
+    csp::util::NoTrail trail;
+    std::vector<std::size_t> changed;
+    EXPECT_TRUE(capacity.filter(trail, changed));
+    EXPECT_EQ(changed, std::vector<std::size_t>{0});
+    EXPECT_EQ(a->valueDomain(), (std::list{1, 2, 3}));
+    EXPECT_EQ(b->valueDomain(), (std::list{2, 3, 4}));
+    EXPECT_EQ(c->valueDomain(), (std::list{0, 1, 2}));
+    b->assign(4);
+    changed.clear();
+    EXPECT_TRUE(capacity.filter(trail, changed));
+    EXPECT_EQ(a->valueDomain(), std::list{1});
+    EXPECT_EQ(c->valueDomain(), std::list{0});
+    a->assign(2);
+    EXPECT_FALSE(capacity.filter(trail, changed));
+}
@@ -0,0 +1,145 @@
+//
+// Created by tim on 18.10.26.
+//
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+#include <stdexcept>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <array>
+
+#include "TestTypes.h"
+#include "TestProblems.h"
+#include "ParallelSearch.h"
+#include "TableConstraint.h"
+
+TEST(parallel_search_test, solve) {
+    for (unsigned int threads : {1u, 2u, 4u}) {
+        for (int n : {1, 8, 14, 20}) {
+            auto [problem, constraints] = makeQueens(n);
+            EXPECT_EQ(csp::solveParallel(problem, threads), csp::SolveResult::Solved);
+            expectSolution(constraints);
+        }
+    }
+
+    auto [problem, constraints] = makeQueens(16);
+    EXPECT_EQ(csp::solveParallel(problem, 3, csp::strategies::DomWdeg<VarPtr>(),
+                                 csp::strategies::RandomValueOrder(7)), csp::SolveResult::Solved);
+    expectSolution(constraints);
+    auto [first, firstConstraints] = makeQueens(12);
+    EXPECT_EQ(csp::solveParallel(first, 4, csp::strategies::First<VarPtr>()), csp::SolveResult::Solved);
+    expectSolution(firstConstraints);
+}
+
+TEST(parallel_search_test, unsatisfiable) {
+    for (unsigned int threads : {1u, 4u}) {
+        auto [queens, unused] = makeQueens(3);
+        EXPECT_EQ(csp::solveParallel(queens, threads), csp::SolveResult::Unsatisfiable);
+        auto [pigeons, constraints] = makePigeonhole(7);
+        EXPECT_EQ(csp::solveParallel(pigeons, threads), csp::SolveResult::Unsatisfiable);
+        // the domains are left in the state after the initial propagation
+        EXPECT_EQ(pigeons.variables.front()->valueDomain().size(), 7);
+    }
+}
+
+TEST(parallel_search_test, limits) {
+    auto [problem, constraints] = makePigeonhole(8);
+    csp::SolverOptions options;
+    options.limits.nodes = 10;
+    EXPECT_EQ(csp::solveParallel(problem, 4, csp::strategies::Mrv<VarPtr>(), csp::strategies::DomainOrder(), options),
+              csp::SolveResult::Aborted);
+    options = {};
+    csp::CancellationToken token;
+    options.limits.cancellation = token;
+    token.cancel();
+    EXPECT_EQ(csp::solveParallel(problem, 4, csp::strategies::Mrv<VarPtr>(), csp::strategies::DomainOrder(), options),
+              csp::SolveResult::Aborted);
+    options = {};
+    options.limits.deadline = std::chrono::steady_clock::now();
+    EXPECT_EQ(csp::solveParallel(problem, 2, csp::strategies::Mrv<VarPtr>(), csp::strategies::DomainOrder(), options),
+              csp::SolveResult::Aborted);
+}
+
+TEST(parallel_search_test, exceptions) {
+    auto [problem, constraints] = makeQueens(30);
+    std::atomic<int> calls = 0;
+    auto strategy = [&calls](const csp::Csp<VarPtr> &problem) -> VarPtr {
+        if (++calls > 5) {
+            throw std::runtime_error("strategy failed");
+        }
+
+        return csp::strategies::First<VarPtr>()(problem);
+    };
+
+    EXPECT_THROW(csp::solveParallel(problem, 4, strategy), std::runtime_error);
+}
+
+TEST(parallel_search_test, table_constraints) {
+    // random ternary tables. The tables of a worker are rebuilt for each task
+    std::mt19937 rng(42);
+    std::bernoulli_distribution allowed(0.4);
+    for (int instance = 0; instance < 40; ++instance) {
+        std::vector<std::array<std::size_t, 3>> scopes;
+        std::vector<std::vector<std::vector<int>>> tables;
+        for (int i = 0; i < 16; ++i) {
+            std::array<std::size_t, 3> scope{};
+            std::vector<std::size_t> order(12);
+            std::iota(order.begin(), order.end(), 0);
+            std::shuffle(order.begin(), order.end(), rng);
+            std::copy_n(order.begin(), 3, scope.begin());
+            std::vector<std::vector<int>> tuples;
+            for (int a = 0; a < 4; ++a) {
+                for (int b = 0; b < 4; ++b) {
+                    for (int c = 0; c < 4; ++c) {
+                        if (allowed(rng)) {
+                            tuples.push_back({a, b, c});
+                        }
+                    }
+                }
+            }
+
+            scopes.emplace_back(scope);
+            tables.emplace_back(std::move(tuples));
+        }
+
+        auto makeProblem = [&scopes, &tables]() {
+            std::vector<VarPtr> vars;
+            for (int i = 0; i < 12; ++i) {
+                vars.emplace_back(std::make_shared<TestVar>(std::list{0, 1, 2, 3}));
+            }
+
+            csp::ConstraintSet<VarPtr> constraints;
+            for (std::size_t i = 0; i < scopes.size(); ++i) {
+                constraints.add(csp::TableConstraint<VarPtr>({vars[scopes[i][0]], vars[scopes[i][1]],
+                                                              vars[scopes[i][2]]}, tables[i]));
+            }
+
+            return csp::make_csp(vars, constraints);
+        };
+
+        auto sequential = makeProblem();
+        const auto expected = csp::trySolve(sequential);
+        for (unsigned int threads : {2u, 4u}) {
+            auto problem = makeProblem();
+            ASSERT_EQ(csp::solveParallel(problem, threads), expected);
+            if (expected != csp::SolveResult::Solved) {
+                continue;
+            }
+
+            for (std::size_t i = 0; i < scopes.size(); ++i) {
+                std::vector<int> tuple;
+                for (auto var : scopes[i]) {
+                    ASSERT_EQ(problem.variables[var]->valueDomain().size(), 1);
+                    tuple.emplace_back(problem.variables[var]->valueDomain().front());
+                }
+
+                EXPECT_NE(std::find(tables[i].begin(), tables[i].end(), tuple), tables[i].end());
+            }
+        }
+    }
+}
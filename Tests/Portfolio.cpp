@@ -0,0 +1,67 @@
+//
+// Created by tim on 18.10.26.
+//
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+#include <stdexcept>
+
+#include "TestTypes.h"
+#include "TestProblems.h"
+#include "Portfolio.h"
+
+TEST(portfolio_test, solve) {
+    csp::Portfolio<VarPtr> portfolio;
+    portfolio.add(csp::strategies::Mrv<VarPtr>());
+    portfolio.add(csp::strategies::First<VarPtr>());
+    portfolio.add(csp::strategies::Mrv<VarPtr>(3), csp::strategies::RandomValueOrder(3));
+    csp::SolverOptions options;
+    options.backjumping = true;
+    portfolio.add(csp::strategies::DomWdeg<VarPtr>(), csp::strategies::DomainOrder(), options);
+    EXPECT_EQ(portfolio.size(), 4);
+    auto [problem, constraints] = makeQueens(16);
+    EXPECT_EQ(portfolio.solve(problem), csp::SolveResult::Solved);
+    EXPECT_LT(portfolio.winner(), portfolio.size());
+    expectSolution(constraints);
+
+    auto [unsolvable, unused] = makeQueens(3);
+    EXPECT_EQ(portfolio.solve(unsolvable), csp::SolveResult::Unsatisfiable);
+    EXPECT_EQ(unsolvable.variables.front()->valueDomain().size(), 3);
+}
+
+TEST(portfolio_test, limits) {
+    csp::Portfolio<VarPtr> portfolio;
+    auto [small, unused] = makeQueens(4);
+    EXPECT_THROW(portfolio.solve(small), std::invalid_argument);
+    csp::SolverOptions options;
+    options.limits.nodes = 1;
+    portfolio.add(csp::strategies::First<VarPtr>(), csp::strategies::DomainOrder(), options);
+    portfolio.add(csp::strategies::Mrv<VarPtr>(), csp::strategies::DomainOrder(), options);
+    auto [problem, constraints] = makeQueens(12);
+    EXPECT_EQ(portfolio.solve(problem), csp::SolveResult::Aborted);
+    EXPECT_EQ(portfolio.winner(), csp::Portfolio<VarPtr>::None);
+
+    // a configuration that reaches its limit does not stop the others
+    portfolio.add(csp::strategies::Mrv<VarPtr>());
+    EXPECT_EQ(portfolio.solve(problem), csp::SolveResult::Solved);
+    EXPECT_EQ(portfolio.winner(), 2);
+
+    csp::CancellationToken token;
+    auto child = token.child();
+    EXPECT_FALSE(child.cancelled());
+    child.cancel();
+    EXPECT_FALSE(token.cancelled());
+    auto other = token.child();
+    token.cancel();
+    EXPECT_TRUE(other.cancelled());
+}
+
+TEST(portfolio_test, exceptions) {
+    csp::Portfolio<VarPtr> portfolio;
+    portfolio.add(csp::strategies::Mrv<VarPtr>());
+    portfolio.add([](const csp::Csp<VarPtr> &) -> VarPtr { throw std::runtime_error("strategy failed"); });
+    // the other configuration must not finish before the strategy throws
+    auto [problem, constraints] = makePigeonhole(9);
+    EXPECT_THROW(portfolio.solve(problem), std::runtime_error);
+}
@@ -0,0 +1,102 @@
+//
+// Created by tim on 18.10.26.
+//
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <limits>
+
+#include "TestTypes.h"
+#include "csp_solver.h"
+
+TEST(propagator_test, residual_supports) {
+    using namespace csp;
+    auto varA = std::make_shared<TestVar>(std::list{1, 2, 3, 4});
+    auto varB = std::make_shared<TestVar>(std::list{1, 2, 3, 4});
+    auto problem = make_csp(std::array{varA, varB}, std::array{TestConstraint(varA, varB, std::less<>())});
+    util::ResidualSupports<VarPtr> residues(problem);
+    util::NoTrail trail;
+    EXPECT_TRUE(residues.removeInconsistent(problem, 0, trail));
+    EXPECT_EQ(varA->valueDomain(), (std::list{1, 2, 3}));
+    EXPECT_FALSE(residues.removeInconsistent(problem, 0, trail));
+    varB->valueDomain().remove(2);
+    varB->valueDomain().remove(4);
+    EXPECT_TRUE(residues.removeInconsistent(problem, 0, trail));
+    EXPECT_EQ(varA->valueDomain(), (std::list{1, 2}));
+}
+
+TEST(propagator_test, ac3rm_equals_ac3) {
+    using namespace csp;
+    auto makeProblem = [](auto &vars) {
+        for (auto &var : vars) {
+            var = std::make_shared<TestVar>(std::list{1, 2, 3, 4, 5});
+        }
+
+        return make_csp(vars, std::array{TestConstraint(vars[0], vars[1], std::less<>()),
+                                         TestConstraint(vars[1], vars[2], std::less<>()),
+                                         TestConstraint(vars[2], vars[3], std::greater<>())});
+    };
+
+    std::array<VarPtr, 4> ac3Vars, ac3rmVars;
+    auto ac3Problem = makeProblem(ac3Vars);
+    auto ac3rmProblem = makeProblem(ac3rmVars);
+    util::NoTrail trail;
+    util::Propagator<VarPtr> ac3(ac3Problem, Propagation::Ac3);
+    util::Propagator<VarPtr> ac3rm(ac3rmProblem, Propagation::Ac3rm);
+    ASSERT_TRUE(ac3.propagate(trail));
+    ASSERT_TRUE(ac3rm.propagate(trail));
+    ac3Vars[2]->assign(4);
+    ac3rmVars[2]->assign(4);
+    ASSERT_TRUE(ac3.propagateFrom(2, trail));
+    ASSERT_TRUE(ac3rm.propagateFrom(2, trail));
+    for (std::size_t i = 0; i < ac3Vars.size(); ++i) {
+        EXPECT_EQ(ac3Vars[i]->valueDomain(), ac3rmVars[i]->valueDomain());
+    }
+}
+
+TEST(propagator_test, solve_ac3rm) {
+    auto varA = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3});
+    auto varB = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3});
+    auto varC = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3});
+    BitsetConstraint aNotB(varA, varB, std::not_equal_to<>());
+    BitsetConstraint bLessC(varB, varC, std::less<>());
+    BitsetConstraint aLessC(varA, varC, std::less<>());
+    auto problem = csp::make_csp(std::array{varA, varB, varC}, std::array{aNotB, bLessC, aLessC});
+    csp::SolverOptions options;
+    options.propagation = csp::Propagation::Ac3rm;
+    EXPECT_TRUE(csp::solve(problem, csp::strategies::Mrv<BitsetVarPtr>(), options));
+    EXPECT_EQ(varC->valueDomain().front(), 3);
+    EXPECT_NE(varA->valueDomain().front(), varB->valueDomain().front());
+}
+
+TEST(propagator_test, ac3rm_non_integral_fallback) {
+    using DoubleVar = csp::Variable<double>;
+    auto varA = std::make_shared<DoubleVar>(DoubleVar{0.5, 1.5});
+    auto varB = std::make_shared<DoubleVar>(DoubleVar{0.5, 1.5});
+    auto problem = csp::make_csp(std::array{varA, varB},
+                                 std::array{csp::Constraint(varA, varB, std::less<>())});
+    csp::SolverOptions options;
+    options.propagation = csp::Propagation::Ac3rm;
+    EXPECT_TRUE(csp::solve(problem, csp::strategies::Mrv<std::shared_ptr<DoubleVar>>(), options));
+    EXPECT_EQ(varA->valueDomain().front(), 0.5);
+}
+
+TEST(propagator_test, ac3rm_sparse_domains) {
+    // value ranges that are too large for residue tables fall back to AC-3 instead of allocating the whole range
+    auto varA = std::make_shared<TestVar>(std::list{0, 1000000000});
+    auto varB = std::make_shared<TestVar>(std::list{0, 1000000000});
+    auto problem = csp::make_csp(std::array{varA, varB},
+                                 std::array{TestConstraint(varA, varB, std::not_equal_to<>())});
+    csp::SolverOptions options;
+    options.propagation = csp::Propagation::Ac3rm;
+    EXPECT_TRUE(csp::solve(problem, csp::strategies::Mrv<VarPtr>(), options));
+    EXPECT_NE(varA->valueDomain().front(), varB->valueDomain().front());
+
+    using LongVar = csp::Variable<long long>;
+    constexpr auto min = std::numeric_limits<long long>::min(), max = std::numeric_limits<long long>::max();
+    auto varC = std::make_shared<LongVar>(LongVar{min, max});
+    auto varD = std::make_shared<LongVar>(LongVar{min, 0, max});
+    auto full = csp::make_csp(std::array{varC, varD}, std::array{csp::Constraint(varC, varD, std::less<>())});
+    EXPECT_TRUE(csp::solve(full, csp::strategies::Mrv<std::shared_ptr<LongVar>>(), options));
+    EXPECT_LT(varC->valueDomain().front(), varD->valueDomain().front());
+}
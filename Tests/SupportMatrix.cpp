@@ -0,0 +1,143 @@
+//
+// Created by tim on 18.10.26.
+//
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <limits>
+
+#include "TestTypes.h"
+#include "csp_solver.h"
+
+TEST(support_matrix_test, rows_and_columns) {
+    using Matrix = csp::SupportMatrix<int>;
+    std::list d1{-1, 0, 1};
+    std::list d2{0, 1, 2, 70};
+    Matrix m(Matrix::Universe::of(d1), Matrix::Universe::of(d2), d1, d2, std::less<>());
+    EXPECT_EQ(m.sourceUniverse(false).offset, -1);
+    EXPECT_EQ(m.targetUniverse(false).size, 71);
+    const auto *row = m.row(0, false);
+    ASSERT_NE(row, nullptr);
+    EXPECT_FALSE(m.test(row, 0, false));
+    EXPECT_TRUE(m.test(row, 1, false));
+    EXPECT_TRUE(m.test(row, 70, false));
+    EXPECT_FALSE(m.test(row, 71, false));
+    EXPECT_EQ(m.row(2, false), nullptr);
+    const auto *column = m.row(0, true);
+    ASSERT_NE(column, nullptr);
+    EXPECT_TRUE(m.test(column, -1, true));
+    EXPECT_FALSE(m.test(column, 0, true));
+}
+
+TEST(support_matrix_test, shared_between_arcs) {
+    auto varA = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto varB = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto varC = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto problem = csp::make_csp(std::array{varA, varB, varC},
+                                 std::array{TestConstraint(varA, varB, std::less<>()),
+                                            TestConstraint(varB, varC, std::less<>())},
+                                 csp::ConstraintMode::Matrix);
+    EXPECT_EQ(problem.supportMatrices.size(), 2);
+    ASSERT_EQ(problem.arcSupports.size(), 4);
+    EXPECT_EQ(problem.arcSupports[0].matrix, problem.arcSupports[1].matrix);
+    EXPECT_NE(problem.arcSupports[0].transposed, problem.arcSupports[1].transposed);
+    EXPECT_TRUE(csp::util::ac3(problem));
+    csp::util::NoTrail trail;
+    for (std::size_t arc = 0; arc < problem.arcs.size(); ++arc) {
+        EXPECT_FALSE(csp::util::removeInconsistent(problem, arc, trail));
+    }
+
+    varA->valueDomain() = {2, 3};
+    EXPECT_TRUE(csp::util::removeInconsistent(problem, 1, trail));
+    EXPECT_TRUE(varB->valueDomain().empty());
+}
+
+TEST(support_matrix_test, solve_bitset) {
+    auto varA = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3});
+    auto varB = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3});
+    auto varC = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3});
+    BitsetConstraint aLessB(varA, varB, std::less<>());
+    BitsetConstraint bLessC(varB, varC, std::less<>());
+    auto problem = csp::make_csp(std::array{varA, varB, varC}, std::array{aLessB, bLessC},
+                                 csp::ConstraintMode::Matrix);
+    EXPECT_TRUE(csp::solve(problem));
+    EXPECT_EQ(varA->valueDomain().front(), 1);
+    EXPECT_EQ(varB->valueDomain().front(), 2);
+    EXPECT_EQ(varC->valueDomain().front(), 3);
+}
+
+TEST(support_matrix_test, ac3_bitset) {
+    auto varA = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3, 4});
+    auto varB = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3, 4});
+    std::size_t calls = 0;
+    BitsetConstraint aLessB(varA, varB, [&calls](int a, int b) {
+        ++calls;
+        return a < b;
+    });
+    auto problem = csp::make_csp(std::array{varA, varB}, std::array{aLessB}, csp::ConstraintMode::Matrix);
+    calls = 0;
+    EXPECT_TRUE(csp::util::ac3(problem));
+    EXPECT_EQ(varA->valueDomain(), (BitsetVar::DomainT{1, 2, 3}));
+    EXPECT_EQ(varB->valueDomain(), (BitsetVar::DomainT{2, 3, 4}));
+    // supports are only checked using the matrix
+    EXPECT_EQ(calls, 0);
+}
+
+TEST(support_matrix_test, non_integral_values) {
+    using DoubleVar = csp::Variable<double>;
+    auto varA = std::make_shared<DoubleVar>(DoubleVar{0.5, 1.5});
+    auto varB = std::make_shared<DoubleVar>(DoubleVar{0.5, 1.5});
+    EXPECT_THROW(csp::make_csp(std::array{varA, varB}, std::array{csp::Constraint(varA, varB, std::less<>())},
+                               csp::ConstraintMode::Matrix), std::invalid_argument);
+}
+
+TEST(support_matrix_test, uncompiled_values) {
+    // values inside of the universe that were not part of the initial domains are checked using the predicate
+    auto varA = std::make_shared<TestVar>(std::list{1, 5});
+    auto varB = std::make_shared<TestVar>(std::list{1, 5});
+    auto problem = csp::make_csp(std::array{varA, varB}, std::array{TestConstraint(varA, varB, std::less<>())},
+                                 csp::ConstraintMode::Matrix);
+    const auto &matrix = problem.supportMatrices.front();
+    EXPECT_TRUE(matrix.sourceCompiled(1, false));
+    EXPECT_FALSE(matrix.sourceCompiled(3, false));
+    EXPECT_FALSE(matrix.targetCompiled(3, false));
+    varA->setValueDomain(std::list{1});
+    varB->setValueDomain(std::list{3});
+    EXPECT_TRUE(csp::solve(problem));
+    EXPECT_EQ(varA->valueDomain().front(), 1);
+    EXPECT_EQ(varB->valueDomain().front(), 3);
+
+    auto bitA = std::make_shared<BitsetVar>(BitsetVar{1, 5});
+    auto bitB = std::make_shared<BitsetVar>(BitsetVar{1, 5});
+    auto bitProblem = csp::make_csp(std::array{bitA, bitB}, std::array{BitsetConstraint(bitA, bitB, std::less<>())},
+                                    csp::ConstraintMode::Matrix);
+    bitA->setValueDomain(BitsetVar::DomainT{1, 4});
+    bitB->setValueDomain(BitsetVar::DomainT{3, 5});
+    EXPECT_TRUE(csp::util::ac3(bitProblem));
+    EXPECT_EQ(bitA->valueDomain(), (BitsetVar::DomainT{1, 4}));
+    EXPECT_EQ(bitB->valueDomain(), (BitsetVar::DomainT{3, 5}));
+    bitB->setValueDomain(BitsetVar::DomainT{3});
+    EXPECT_TRUE(csp::util::ac3(bitProblem));
+    EXPECT_EQ(bitA->valueDomain(), (BitsetVar::DomainT{1}));
+}
+
+TEST(support_matrix_test, sparse_universe) {
+    using Matrix = csp::SupportMatrix<long long>;
+    constexpr auto min = std::numeric_limits<long long>::min(), max = std::numeric_limits<long long>::max();
+    std::list d1{min, max};
+    std::list d2{0ll, 1ll};
+    // the range of d1 is far too large to be compiled
+    Matrix m(Matrix::Universe::of(d1), Matrix::Universe::of(d2), d1, d2, std::less<>());
+    EXPECT_EQ(m.sourceUniverse(false).size, 0);
+    EXPECT_FALSE(m.sourceCompiled(min, false));
+    EXPECT_EQ(m.row(min, false), nullptr);
+    EXPECT_TRUE(m.targetCompiled(1, false));
+
+    auto varA = std::make_shared<TestVar>(std::list{0, 1000000000});
+    auto varB = std::make_shared<TestVar>(std::list{0, 1000000000});
+    auto problem = csp::make_csp(std::array{varA, varB}, std::array{TestConstraint(varA, varB, std::less<>())},
+                                 csp::ConstraintMode::Matrix);
+    EXPECT_TRUE(csp::solve(problem));
+    EXPECT_EQ(varA->valueDomain().front(), 0);
+    EXPECT_EQ(varB->valueDomain().front(), 1000000000);
+}
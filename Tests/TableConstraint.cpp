@@ -0,0 +1,109 @@
+//
+// Created by tim on 18.10.26.
+//
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include "TestTypes.h"
+#include "TableConstraint.h"
+#include "Trail.h"
+
+std::vector<std::vector<int>> permutations(int n) {
+    std::vector<int> values(static_cast<std::size_t>(n));
+    for (int i = 0; i < n; ++i) {
+        values[static_cast<std::size_t>(i)] = i + 1;
+    }
+
+    std::vector<std::vector<int>> ret;
+    do {
+        ret.emplace_back(values);
+    } while (std::next_permutation(values.begin(), values.end()));
+    return ret;
+}
+
+TEST(table_constraint_test, gac) {
+    auto a = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto b = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto c = std::make_shared<TestVar>(std::list{1, 2, 3, 4});
+    csp::TableConstraint<VarPtr> table({a, b, c}, {{1, 2, 3}, {2, 2, 1}, {3, 1, 1}, {1, 3, 5}});
+    csp::util::NoTrail trail;
+    std::vector<std::size_t> changed;
+    EXPECT_TRUE(table.filter(trail, changed));
+    EXPECT_EQ(changed, (std::vector<std::size_t>{1, 2}));
+    EXPECT_EQ(b->valueDomain(), (std::list{1, 2}));
+    EXPECT_EQ(c->valueDomain(), (std::list{1, 3}));
+    EXPECT_EQ(table.validTuples(), 3);
+    c->assign(1);
+    changed.clear();
+    EXPECT_TRUE(table.filter(trail, changed));
+    EXPECT_EQ(changed, (std::vector<std::size_t>{0}));
+    EXPECT_EQ(a->valueDomain(), (std::list{2, 3}));
+    EXPECT_EQ(b->valueDomain(), (std::list{1, 2}));
+    EXPECT_EQ(table.validTuples(), 2);
+}
+
+TEST(table_constraint_test, inconsistent) {
+    auto a = std::make_shared<BitsetVar>(BitsetVar{1, 2});
+    auto b = std::make_shared<BitsetVar>(BitsetVar{1, 2});
+    csp::TableConstraint<BitsetVarPtr> table({a, b}, {{1, 3}, {3, 2}});
+    csp::util::NoTrail trail;
+    std::vector<std::size_t> changed;
+    EXPECT_FALSE(table.filter(trail, changed));
+    EXPECT_THROW(csp::TableConstraint<BitsetVarPtr>({a, b}, {{1, 2, 3}}), std::invalid_argument);
+}
+
+TEST(table_constraint_test, trail) {
+    std::vector<BitsetVarPtr> vars;
+    for (int i = 0; i < 5; ++i) {
+        vars.emplace_back(std::make_shared<BitsetVar>(BitsetVar{1, 2, 3, 4, 5}));
+    }
+
+    csp::TableConstraint<BitsetVarPtr> table(vars, permutations(5));
+    struct Problem {
+        std::vector<BitsetVarPtr> variables;
+    } problem{vars};
+    csp::util::Trail<BitsetVarPtr> trail(problem);
+    std::vector<std::size_t> changed;
+    EXPECT_TRUE(table.filter(trail, changed));
+    EXPECT_EQ(table.validTuples(), 120);
+    trail.push();
+    trail.save(vars[0]);
+    vars[0]->assign(1);
+    EXPECT_TRUE(table.filter(trail, changed));
+    EXPECT_EQ(table.validTuples(), 24);
+    trail.push();
+    trail.save(vars[1]);
+    vars[1]->assign(2);
+    EXPECT_TRUE(table.filter(trail, changed));
+    EXPECT_EQ(table.validTuples(), 6);
+    EXPECT_EQ(vars[4]->valueDomain(), (BitsetVar::DomainT{3, 4, 5}));
+    trail.pop();
+    EXPECT_EQ(table.validTuples(), 24);
+    EXPECT_EQ(vars[4]->valueDomain(), (BitsetVar::DomainT{2, 3, 4, 5}));
+    trail.push();
+    trail.save(vars[1]);
+    vars[1]->setValueDomain(BitsetVar::DomainT{3, 4});
+    trail.save(vars[2]);
+    vars[2]->setValueDomain(BitsetVar::DomainT{3, 4});
+    changed.clear();
+    EXPECT_TRUE(table.filter(trail, changed));
+    EXPECT_EQ(table.validTuples(), 4);
+    EXPECT_EQ(changed, (std::vector<std::size_t>{3, 4}));
+    EXPECT_EQ(vars[3]->valueDomain(), (BitsetVar::DomainT{2, 5}));
+    trail.pop();
+    trail.pop();
+    EXPECT_EQ(table.validTuples(), 120);
+    EXPECT_EQ(vars[3]->valueDomain(), (BitsetVar::DomainT{1, 2, 3, 4, 5}));
+}
+
+TEST(table_constraint_test, satisfied) {
+    auto a = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto b = std::make_shared<TestVar>(std::list{1, 2, 3});
+    csp::TableConstraint<VarPtr> table({a, b}, {{1, 2}, {2, 3}});
+    EXPECT_TRUE(table.satisfied(std::vector{2, 3}));
+    EXPECT_FALSE(table.satisfied(std::vector{1, 3}));
+    EXPECT_FALSE(table.satisfied(std::vector{4, 2}));
+}
@@ -0,0 +1,80 @@
+//
+// Created by tim on 18.10.26.
+//
+
+#ifndef CSP_SOLVER_TESTPROBLEMS_H
+#define CSP_SOLVER_TESTPROBLEMS_H
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+#include <list>
+#include <cstdlib>
+#include <utility>
+#include <functional>
+
+#include "TestTypes.h"
+#include "Csp.h"
+
+/**
+ * n-queens problem with one variable per column
+ * @param n size of the board
+ * @return the csp and its binary constraints
+ */
+inline auto makeQueens(int n) {
+    std::vector<VarPtr> queens;
+    std::vector<TestConstraint> constraints;
+    std::list<int> domain;
+    for (int i = 0; i < n; ++i) {
+        domain.emplace_back(i);
+    }
+
+    for (int i = 0; i < n; ++i) {
+        queens.emplace_back(std::make_shared<TestVar>(domain));
+        for (int j = 0; j < i; ++j) {
+            constraints.emplace_back(queens[j], queens[i], [dist = i - j](int a, int b) {
+                return a != b && std::abs(a - b) != dist;
+            });
+        }
+    }
+
+    return std::make_pair(csp::make_csp(queens, constraints), constraints);
+}
+
+/**
+ * n + 1 pigeons in n holes. Arc consistency removes no values, so the whole search tree has to be explored
+ * @param n number of holes
+ * @return the csp and its binary constraints
+ */
+inline auto makePigeonhole(int n) {
+    std::vector<VarPtr> pigeons;
+    std::vector<TestConstraint> constraints;
+    std::list<int> domain;
+    for (int i = 0; i < n; ++i) {
+        domain.emplace_back(i);
+    }
+
+    for (int i = 0; i <= n; ++i) {
+        pigeons.emplace_back(std::make_shared<TestVar>(domain));
+        for (int j = 0; j < i; ++j) {
+            constraints.emplace_back(pigeons[j], pigeons[i], std::not_equal_to<>());
+        }
+    }
+
+    return std::make_pair(csp::make_csp(pigeons, constraints), constraints);
+}
+
+/**
+ * Checks that all variables of the constraints are assigned and that all constraints are satisfied
+ * @param constraints binary constraints of a solved csp
+ */
+inline void expectSolution(const std::vector<TestConstraint> &constraints) {
+    for (const auto &constraint : constraints) {
+        auto [arc, reversed] = constraint.getArcs();
+        ASSERT_EQ(arc.from()->valueDomain().size(), 1);
+        ASSERT_EQ(arc.to()->valueDomain().size(), 1);
+        EXPECT_TRUE(arc.constraintSatisfied(arc.from()->valueDomain().front(), arc.to()->valueDomain().front()));
+    }
+}
+
+#endif //CSP_SOLVER_TESTPROBLEMS_H
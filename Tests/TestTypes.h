@@ -8,11 +8,15 @@
 #include <memory>
 
 #include "Variable.h"
+#include "BitsetDomain.h"
 #include "Arc.h"
 
 using TestVar = csp::Variable<int>;
 using VarPtr = std::shared_ptr<TestVar>;
 using TestArc = csp::Arc<VarPtr>;
 using TestConstraint = csp::Constraint<VarPtr>;
+using BitsetVar = csp::Variable<int, csp::Bitset<16>::Domain>;
+using BitsetVarPtr = std::shared_ptr<BitsetVar>;
+using BitsetConstraint = csp::Constraint<BitsetVarPtr>;
 
 #endif //CSP_SOLVER_TESTTYPES_H
@@ -0,0 +1,102 @@
+//
+// Created by tim on 18.10.26.
+//
+
+#include <gtest/gtest.h>
+#include <memory>
+
+#include "TestTypes.h"
+#include "Trail.h"
+#include "util.h"
+
+TEST(trail_test, restore_modified_domains) {
+    std::array vars = {std::make_shared<TestVar>(std::list{1, 2, 3}),
+                       std::make_shared<TestVar>(std::list{4, 5, 6}),
+                       std::make_shared<TestVar>(std::list{7, 8, 9})};
+    auto problem = csp::make_csp(vars, std::vector<TestConstraint>{});
+    csp::util::Trail<VarPtr> trail(problem);
+    trail.push();
+    trail.save(vars[0]);
+    vars[0]->assign(1);
+    trail.save(vars[0]);
+    vars[0]->valueDomain().clear();
+    EXPECT_EQ(trail.size(), 1);
+    trail.push();
+    trail.save(vars[1]);
+    vars[1]->assign(5);
+    trail.save(vars[0]);
+    vars[0]->assign(3);
+    EXPECT_EQ(trail.size(), 3);
+    EXPECT_EQ(trail.depth(), 2);
+    trail.pop();
+    EXPECT_TRUE(vars[0]->valueDomain().empty());
+    EXPECT_EQ(vars[1]->valueDomain(), (std::list{4, 5, 6}));
+    trail.pop();
+    EXPECT_EQ(vars[0]->valueDomain(), (std::list{1, 2, 3}));
+    EXPECT_EQ(vars[2]->valueDomain(), (std::list{7, 8, 9}));
+    EXPECT_EQ(trail.size(), 0);
+}
+
+TEST(trail_test, save_by_index) {
+    std::array vars = {std::make_shared<TestVar>(std::list{1, 2, 3}),
+                       std::make_shared<TestVar>(std::list{4, 5, 6})};
+    auto problem = csp::make_csp(vars, std::vector<TestConstraint>{});
+    csp::util::Trail<VarPtr> trail(problem);
+    trail.save(1, vars[1]);
+    EXPECT_EQ(trail.size(), 0);
+    trail.push();
+    trail.save(1, vars[1]);
+    vars[1]->assign(4);
+    // both overloads share the stamp of the variable
+    trail.save(vars[1]);
+    trail.save(1, vars[1]);
+    EXPECT_EQ(trail.size(), 1);
+    trail.save(0, vars[0]);
+    vars[0]->assign(2);
+    EXPECT_EQ(trail.size(), 2);
+    trail.pop();
+    EXPECT_EQ(vars[0]->valueDomain(), (std::list{1, 2, 3}));
+    EXPECT_EQ(vars[1]->valueDomain(), (std::list{4, 5, 6}));
+}
+
+TEST(trail_test, ac3_undo) {
+    using namespace csp;
+    auto varA = std::make_shared<TestVar>(std::list{2, 3, 1});
+    auto varB = std::make_shared<TestVar>(std::list{2, 3, 1});
+    auto varC = std::make_shared<TestVar>(std::list{2, 3, 1});
+    TestConstraint aLessB(varA, varB, std::less<>());
+    TestConstraint aLessC(varA, varC, std::less<>());
+    Csp problem = make_csp(std::array{varA, varB, varC}, std::array{aLessB, aLessC});
+    util::Trail<VarPtr> trail(problem);
+    trail.push();
+    EXPECT_TRUE(util::ac3(problem, trail));
+    EXPECT_EQ(varA->valueDomain(), (std::list{2, 1}));
+    EXPECT_EQ(trail.size(), 3);
+    trail.pop();
+    EXPECT_EQ(varA->valueDomain(), (std::list{2, 3, 1}));
+    EXPECT_EQ(varB->valueDomain(), (std::list{2, 3, 1}));
+    EXPECT_EQ(varC->valueDomain(), (std::list{2, 3, 1}));
+}
+
+TEST(trail_test, restore_words) {
+    auto var = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto problem = csp::make_csp(std::array{var}, std::vector<TestConstraint>{});
+    csp::util::Trail<VarPtr> trail(problem);
+    std::uint64_t word = 5;
+    trail.saveWord(word);
+    word = 6;
+    EXPECT_EQ(trail.choicePoint(), 0);
+    trail.push();
+    const std::size_t outer = trail.choicePoint();
+    trail.saveWord(word);
+    word = 7;
+    trail.push();
+    EXPECT_NE(trail.choicePoint(), outer);
+    trail.saveWord(word);
+    word = 8;
+    trail.pop();
+    EXPECT_EQ(word, 7);
+    EXPECT_EQ(trail.choicePoint(), outer);
+    trail.pop();
+    EXPECT_EQ(word, 6);
+}
@@ -4,8 +4,14 @@
 
 #include <gtest/gtest.h>
 #include <iostream>
+#include <span>
+#include <set>
+#include <limits>
+#include <thread>
+#include <chrono>
 
 #include "TestTypes.h"
+#include "TestProblems.h"
 #include "csp_solver.h"
 
 class NamedVar : public csp::Variable<int> {
@@ -93,4 +99,532 @@ TEST(solver_test, backtrack) {
 TEST(solver_test, empty_problem) {
     csp::Csp problem = csp::make_csp(std::vector<VarPtr>{}, std::vector<TestArc>{});
     EXPECT_TRUE(csp::solve(problem));
-}
\ No newline at end of file
+}
+
+TEST(solver_test, typed_constraints) {
+    auto varA = std::make_shared<TestVar>(std::list{1, 2, 3, 4});
+    auto varB = std::make_shared<TestVar>(std::list{1, 2, 3, 4});
+    auto varC = std::make_shared<TestVar>(std::list{1, 2, 3, 4});
+    csp::ConstraintSet<VarPtr> constraints;
+    constraints.emplace(varA, varB, std::less<>());
+    constraints.emplace(varB, varC, [](int b, int c) { return b + c == 5; });
+    constraints.add(TestConstraint(varA, varC, std::not_equal_to<>()));
+    EXPECT_EQ(constraints.size(), 3);
+    auto problem = csp::make_csp(std::array{varA, varB, varC}, constraints);
+    EXPECT_EQ(problem.arcs.size(), 6);
+    EXPECT_EQ(problem.arcRevisers.size(), 6);
+    EXPECT_TRUE(csp::solve(problem));
+    int a = varA->valueDomain().front(), b = varB->valueDomain().front(), c = varC->valueDomain().front();
+    EXPECT_LT(a, b);
+    EXPECT_EQ(b + c, 5);
+    EXPECT_NE(a, c);
+}
+
+TEST(solver_test, typed_constraints_matrix) {
+    auto varA = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3});
+    auto varB = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3});
+    std::array constraints{csp::Constraint<BitsetVarPtr, std::greater<>>(varA, varB, std::greater<>())};
+    auto problem = csp::make_csp(std::array{varA, varB}, constraints, csp::ConstraintMode::Matrix);
+    EXPECT_TRUE(csp::solve(problem));
+    EXPECT_GT(varA->valueDomain().front(), varB->valueDomain().front());
+}
+
+TEST(solver_test, stats) {
+    auto varA = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto varB = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto varC = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto problem = csp::make_csp(std::array{varA, varB, varC},
+                                 std::array{TestConstraint(varA, varB, std::not_equal_to<>()),
+                                            TestConstraint(varA, varC, std::not_equal_to<>()),
+                                            TestConstraint(varB, varC, std::not_equal_to<>())});
+    csp::SolveStats stats;
+    EXPECT_TRUE(csp::solve(problem, csp::strategies::First<VarPtr>(), {}, stats));
+    EXPECT_EQ(stats.nodes, 2);
+    EXPECT_EQ(stats.backtracks, 0);
+    EXPECT_EQ(stats.maxDepth, 2);
+    EXPECT_EQ(stats.ac3Calls, 3);
+    EXPECT_EQ(stats.valuesPruned, 3);
+    EXPECT_GT(stats.arcsRevised, 0);
+    EXPECT_GT(stats.checkpointBytes, 0);
+    EXPECT_GT(stats.propagationTime.count(), 0);
+}
+
+TEST(solver_test, stats_backtracks) {
+    auto varA = std::make_shared<TestVar>(std::list{1, 2});
+    auto varB = std::make_shared<TestVar>(std::list{1, 2});
+    auto varC = std::make_shared<TestVar>(std::list{1, 2, 3});
+    // A = 1 is only refuted after B is assigned
+    auto problem = csp::make_csp(std::array{varA, varB, varC},
+                                 std::array{TestConstraint(varA, varC, std::less<>()),
+                                            TestConstraint(varB, varC, [](int b, int c) { return b + c == 4; }),
+                                            TestConstraint(varA, varB, std::less_equal<>())});
+    csp::SolveStats stats;
+    EXPECT_TRUE(csp::solve(problem, csp::strategies::First<VarPtr>(), {}, stats));
+    EXPECT_GE(stats.nodes, stats.backtracks);
+    EXPECT_LE(stats.maxDepth, 3);
+    EXPECT_EQ(stats.solutions, 1);
+    EXPECT_EQ(stats.ac3Calls, stats.nodes + 1);
+}
+
+TEST(solver_test, incremental_mrv) {
+    auto [problem, constraints] = makeQueens(8);
+    csp::strategies::IncrementalMrv<VarPtr> strategy;
+    ASSERT_TRUE(csp::solve(problem, strategy));
+    expectSolution(constraints);
+}
+
+TEST(solver_test, degree_strategies) {
+    auto solveQueens = [](auto strategy) {
+        auto [problem, constraints] = makeQueens(8);
+        ASSERT_TRUE(csp::solve(problem, strategy));
+        expectSolution(constraints);
+    };
+
+    solveQueens(csp::strategies::DomWdeg<VarPtr>());
+    solveQueens(csp::strategies::MrvDegree<VarPtr>());
+    solveQueens(csp::strategies::MaxDegree<VarPtr>());
+}
+
+TEST(solver_test, dom_wdeg_unsolvable) {
+    auto [problem, constraints] = makePigeonhole(3);
+    csp::SolveStats stats;
+    EXPECT_FALSE(csp::solve(problem, csp::strategies::DomWdeg<VarPtr>(), {}, stats));
+    EXPECT_GT(stats.backtracks, 0);
+}
+
+TEST(solver_test, value_order) {
+    std::vector<VarPtr> vars;
+    for (int i = 0; i < 3; ++i) {
+        vars.emplace_back(std::make_shared<TestVar>(std::list{1, 2, 3, 4}));
+    }
+
+    auto problem = csp::make_csp(vars, std::vector<TestConstraint>{{vars[0], vars[1], std::not_equal_to<>()}});
+    csp::SolveStats stats;
+    ASSERT_TRUE(csp::solve(problem, csp::strategies::First<VarPtr>(),
+                           csp::strategies::ValueComparator(std::greater<>()), {}, stats));
+    EXPECT_EQ(vars[0]->valueDomain().front(), 4);
+    EXPECT_EQ(vars[1]->valueDomain().front(), 3);
+    EXPECT_EQ(vars[2]->valueDomain().front(), 4);
+    EXPECT_EQ(stats.backtracks, 0);
+}
+
+TEST(solver_test, least_constraining_value) {
+    auto [problem, constraints] = makeQueens(8);
+    ASSERT_TRUE(csp::solve(problem, csp::strategies::Mrv<VarPtr>(), csp::strategies::LeastConstrainingValue<VarPtr>()));
+    expectSolution(constraints);
+}
+
+TEST(solver_test, all_different) {
+    // 4x4 latin square with two given values
+    std::vector<VarPtr> cells;
+    for (int i = 0; i < 16; ++i) {
+        cells.emplace_back(std::make_shared<TestVar>(std::list{1, 2, 3, 4}));
+    }
+
+    cells[0]->assign(1);
+    cells[5]->assign(1);
+    csp::ConstraintSet<VarPtr> constraints;
+    for (std::size_t i = 0; i < 4; ++i) {
+        std::vector<VarPtr> row, column;
+        for (std::size_t j = 0; j < 4; ++j) {
+            row.emplace_back(cells[4 * i + j]);
+            column.emplace_back(cells[4 * j + i]);
+        }
+
+        constraints.add(csp::AllDifferent<VarPtr>(std::move(row)));
+        constraints.add(csp::AllDifferent<VarPtr>(std::move(column)));
+    }
+
+    auto problem = csp::make_csp(cells, constraints);
+    csp::SolveStats stats;
+    ASSERT_TRUE(csp::solve(problem, csp::strategies::DomWdeg<VarPtr>(), {}, stats));
+    EXPECT_GT(stats.globalsFiltered, 0);
+    EXPECT_EQ(stats.arcsRevised, 0);
+    for (std::size_t g = 0; g < problem.globalConstraints.size(); ++g) {
+        std::vector<int> values;
+        for (const auto &var : problem.globalConstraints[g].variables()) {
+            ASSERT_TRUE(var->isAssigned());
+            values.emplace_back(var->valueDomain().front());
+        }
+
+        EXPECT_TRUE(csp::AllDifferent<VarPtr>::satisfied(values));
+    }
+}
+
+TEST(solver_test, all_different_pigeonhole) {
+    std::vector<VarPtr> vars;
+    for (int i = 0; i < 5; ++i) {
+        vars.emplace_back(std::make_shared<TestVar>(std::list{1, 2, 3, 4}));
+    }
+
+    csp::ConstraintSet<VarPtr> constraints;
+    constraints.add(csp::AllDifferent<VarPtr>(vars));
+    auto problem = csp::make_csp(vars, constraints);
+    csp::SolveStats stats;
+    EXPECT_FALSE(csp::solve(problem, csp::strategies::Mrv<VarPtr>(), {}, stats));
+    EXPECT_EQ(stats.nodes, 0);
+}
+
+TEST(solver_test, nary_constraints) {
+    auto a = std::make_shared<TestVar>(std::list{1, 2, 3, 4, 5});
+    auto b = std::make_shared<TestVar>(std::list{1, 2, 3, 4, 5});
+    auto c = std::make_shared<TestVar>(std::list{1, 2, 3, 4, 5});
+    auto d = std::make_shared<TestVar>(std::list{1, 2, 3, 4, 5});
+    csp::ConstraintSet<VarPtr> constraints;
+    constraints.add(csp::NaryConstraint(std::vector{a, b, c}, [](std::span<const int> v) {
+        return v[0] + v[1] + v[2] == 10;
+    }));
+    constraints.add(csp::AllDifferent<VarPtr>({a, b, c, d}));
+    constraints.emplace(d, a, std::greater<>());
+    constraints.emplace(a, b, std::less<>());
+    auto problem = csp::make_csp(std::array{a, b, c, d}, constraints);
+    ASSERT_TRUE(csp::solve(problem));
+    int va = a->valueDomain().front(), vb = b->valueDomain().front(), vc = c->valueDomain().front();
+    int vd = d->valueDomain().front();
+    EXPECT_EQ(va + vb + vc, 10);
+    EXPECT_GT(vd, va);
+    EXPECT_LT(va, vb);
+    EXPECT_TRUE(csp::AllDifferent<VarPtr>::satisfied({va, vb, vc, vd}));
+}
+
+TEST(solver_test, table_constraints) {
+    // 4x4 latin square, rows given as tables of permutations, columns as AllDifferent
+    std::vector<std::vector<int>> rows;
+    std::vector<int> perm{1, 2, 3, 4};
+    do {
+        rows.emplace_back(perm);
+    } while (std::next_permutation(perm.begin(), perm.end()));
+
+    std::vector<VarPtr> vars;
+    for (int i = 0; i < 16; ++i) {
+        vars.emplace_back(std::make_shared<TestVar>(std::list{1, 2, 3, 4}));
+    }
+
+    csp::ConstraintSet<VarPtr> constraints;
+    for (std::size_t i = 0; i < 4; ++i) {
+        constraints.add(csp::TableConstraint<VarPtr>({vars[i * 4], vars[i * 4 + 1], vars[i * 4 + 2],
+                                                      vars[i * 4 + 3]}, rows));
+        constraints.add(csp::AllDifferent<VarPtr>({vars[i], vars[i + 4], vars[i + 8], vars[i + 12]}));
+    }
+
+    // first row is 4 3 2 1, diagonal is constant
+    constraints.add(csp::TableConstraint<VarPtr>({vars[0], vars[1]}, {{4, 3}}));
+    for (std::size_t i = 1; i < 4; ++i) {
+        constraints.emplace(vars[0], vars[i * 5], std::equal_to<>());
+    }
+
+    auto problem = csp::make_csp(vars, constraints);
+    ASSERT_TRUE(csp::solve(problem, csp::strategies::DomWdeg<VarPtr>(problem)));
+    for (std::size_t i = 0; i < 4; ++i) {
+        std::vector<int> row, col;
+        for (std::size_t j = 0; j < 4; ++j) {
+            row.emplace_back(vars[i * 4 + j]->valueDomain().front());
+            col.emplace_back(vars[j * 4 + i]->valueDomain().front());
+        }
+
+        EXPECT_TRUE(csp::AllDifferent<VarPtr>::satisfied(row));
+        EXPECT_TRUE(csp::AllDifferent<VarPtr>::satisfied(col));
+        EXPECT_EQ(vars[i * 5]->valueDomain().front(), 4);
+    }
+
+    EXPECT_EQ(vars[1]->valueDomain().front(), 3);
+}
+
+TEST(solver_test, count_solutions) {
+    auto countQueens = [](auto strategy, std::size_t limit) {
+        auto [problem, constraints] = makeQueens(8);
+        return csp::countSolutions(problem, limit, strategy);
+    };
+
+    EXPECT_EQ(countQueens(csp::strategies::Mrv<VarPtr>(), std::numeric_limits<std::size_t>::max()), 92);
+    EXPECT_EQ(countQueens(csp::strategies::IncrementalMrv<VarPtr>(), 1000), 92);
+    EXPECT_EQ(countQueens(csp::strategies::DomWdeg<VarPtr>(), 1000), 92);
+    EXPECT_EQ(countQueens(csp::strategies::First<VarPtr>(), 2), 2);
+    EXPECT_EQ(countQueens(csp::strategies::First<VarPtr>(), 0), 0);
+}
+
+TEST(solver_test, enumerate_solutions) {
+    auto a = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto b = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto c = std::make_shared<TestVar>(std::list{1, 2, 3});
+    csp::ConstraintSet<VarPtr> constraints;
+    constraints.add(csp::AllDifferent<VarPtr>({a, b, c}));
+    constraints.emplace(a, b, std::less<>());
+    auto problem = csp::make_csp(std::array{a, b, c}, constraints);
+    std::set<std::vector<int>> solutions;
+    auto count = csp::enumerateSolutions(problem, [&solutions](const csp::Csp<VarPtr> &p) {
+        std::vector<int> solution;
+        for (const auto &var : p.variables) {
+            EXPECT_TRUE(var->isAssigned());
+            solution.emplace_back(var->valueDomain().front());
+        }
+
+        solutions.emplace(std::move(solution));
+    });
+
+    EXPECT_EQ(count, 3);
+    EXPECT_EQ(solutions, (std::set<std::vector<int>>{{1, 2, 3}, {1, 3, 2}, {2, 3, 1}}));
+    EXPECT_EQ(a->valueDomain(), (std::list{1, 2}));
+    count = csp::enumerateSolutions(problem, [](const csp::Csp<VarPtr> &) { return false; });
+    EXPECT_EQ(count, 1);
+    EXPECT_TRUE(a->isAssigned() && b->isAssigned() && c->isAssigned());
+    EXPECT_LT(a->valueDomain().front(), b->valueDomain().front());
+}
+
+TEST(solver_test, minimize) {
+    // assign 4 tasks to pairwise different slots, cost is the sum of weight * slot
+    const std::array weights{3, 1, 4, 2};
+    std::array<VarPtr, 4> tasks;
+    for (auto &task : tasks) {
+        task = std::make_shared<TestVar>(std::list{1, 2, 3, 4, 5});
+    }
+
+    csp::ConstraintSet<VarPtr> constraints;
+    constraints.add(csp::AllDifferent<VarPtr>(tasks.begin(), tasks.end()));
+    constraints.emplace(tasks[0], tasks[1], std::less<>());
+    auto problem = csp::make_csp(tasks, constraints);
+    auto cost = [&weights](const csp::Csp<VarPtr> &p) {
+        int ret = 0;
+        for (std::size_t i = 0; i < p.variables.size(); ++i) {
+            ret += weights[i] * p.variables[i]->valueDomain().front();
+        }
+
+        return ret;
+    };
+
+    std::size_t boundCalls = 0;
+    auto lowerBound = [&weights, &boundCalls](const csp::Csp<VarPtr> &p) {
+        ++boundCalls;
+        int ret = 0;
+        for (std::size_t i = 0; i < p.variables.size(); ++i) {
+            const auto &domain = p.variables[i]->valueDomain();
+            ret += weights[i] * *std::min_element(domain.begin(), domain.end());
+        }
+
+        return ret;
+    };
+
+    // optimum: task 2 -> 1, task 0 -> 2, task 3 -> 3, task 1 -> 4
+    auto best = csp::minimize(problem, cost, lowerBound, csp::strategies::Mrv<VarPtr>());
+    ASSERT_TRUE(best.has_value());
+    EXPECT_EQ(*best, 3 * 2 + 1 * 4 + 4 * 1 + 2 * 3);
+    EXPECT_EQ(tasks[0]->valueDomain(), std::list{2});
+    EXPECT_EQ(tasks[1]->valueDomain(), std::list{4});
+    EXPECT_EQ(tasks[2]->valueDomain(), std::list{1});
+    EXPECT_EQ(tasks[3]->valueDomain(), std::list{3});
+    EXPECT_GT(boundCalls, 0);
+    for (auto &task : tasks) {
+        task->setValueDomain(std::list{1, 2, 3, 4, 5});
+    }
+
+    EXPECT_EQ(csp::minimize(problem, cost), best);
+    EXPECT_EQ(cost(problem), *best);
+    for (auto &task : tasks) {
+        task->setValueDomain(std::list{1, 2, 3, 4, 5});
+    }
+
+    auto optimal = csp::tryMinimize(problem, cost, lowerBound, csp::strategies::Mrv<VarPtr>());
+    EXPECT_EQ(optimal.result, csp::SolveResult::Solved);
+    EXPECT_EQ(optimal.cost, best);
+    // without a lower bound, the node limit is reached before the search space is explored
+    for (auto &task : tasks) {
+        task->setValueDomain(std::list{1, 2, 3, 4, 5});
+    }
+
+    csp::SolverOptions options;
+    options.limits.nodes = 10;
+    auto aborted = csp::tryMinimize(problem, cost, csp::strategies::Mrv<VarPtr>(), options);
+    EXPECT_EQ(aborted.result, csp::SolveResult::Aborted);
+    ASSERT_TRUE(aborted.cost.has_value());
+    EXPECT_GE(*aborted.cost, *best);
+    EXPECT_EQ(cost(problem), *aborted.cost);
+    for (auto &task : tasks) {
+        task->setValueDomain(std::list{1, 2, 3, 4, 5});
+    }
+
+    EXPECT_FALSE(csp::minimize(problem, cost, csp::strategies::Mrv<VarPtr>(), options).has_value());
+    for (auto &task : tasks) {
+        task->setValueDomain(std::list{1, 2, 3});
+    }
+
+    EXPECT_FALSE(csp::minimize(problem, cost, csp::strategies::First<VarPtr>()).has_value());
+    auto unsatisfiable = csp::tryMinimize(problem, cost);
+    EXPECT_EQ(unsatisfiable.result, csp::SolveResult::Unsatisfiable);
+    EXPECT_FALSE(unsatisfiable.cost.has_value());
+}
+
+TEST(solver_test, backjumping) {
+    // a = 1 restricts c, d, e to {1, 2} which contradicts the pairwise inequalities. The b variables are unrelated
+    auto a = std::make_shared<TestVar>(std::list{1, 2});
+    std::vector<VarPtr> vars{a};
+    for (int i = 0; i < 4; ++i) {
+        vars.emplace_back(std::make_shared<TestVar>(std::list{1, 2, 3}));
+    }
+
+    auto c = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto d = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto e = std::make_shared<TestVar>(std::list{1, 2, 3});
+    vars.insert(vars.end(), {c, d, e});
+    std::vector<TestConstraint> constraints{{c, d, std::not_equal_to<>()}, {d, e, std::not_equal_to<>()},
+                                            {c, e, std::not_equal_to<>()}};
+    for (const auto &var : {c, d, e}) {
+        constraints.emplace_back(a, var, [](int va, int v) { return va != 1 || v != 3; });
+    }
+
+    auto problem = csp::make_csp(vars, constraints);
+    const auto initial = csp::util::makeCspCheckpoint(problem);
+    csp::SolveStats chronological;
+    ASSERT_TRUE(csp::solve(problem, csp::strategies::First<VarPtr>(), {}, chronological));
+    EXPECT_EQ(a->valueDomain(), std::list{2});
+    csp::util::restoreCspFromCheckpoint(problem, initial);
+    csp::SolverOptions options;
+    options.backjumping = true;
+    csp::SolveStats backjumping;
+    ASSERT_TRUE(csp::solve(problem, csp::strategies::First<VarPtr>(), options, backjumping));
+    EXPECT_EQ(a->valueDomain(), std::list{2});
+    expectSolution(constraints);
+
+    EXPECT_GT(backjumping.backjumps, 0);
+    EXPECT_GT(backjumping.nogoods, 0);
+    EXPECT_LT(backjumping.nodes * 4, chronological.nodes);
+}
+
+TEST(solver_test, backjumping_complete) {
+    csp::SolverOptions options;
+    options.backjumping = true;
+    auto [queens, queenConstraints] = makeQueens(8);
+    EXPECT_EQ(csp::countSolutions(queens, 1000, csp::strategies::Mrv<VarPtr>(), options), 92);
+    auto [unsolvable, unused] = makeQueens(3);
+    EXPECT_FALSE(csp::solve(unsolvable, csp::strategies::DomWdeg<VarPtr>(), options));
+    options.nogoodLimit = 2;
+    auto [small, smallConstraints] = makeQueens(10);
+    EXPECT_EQ(csp::countSolutions(small, 1000, csp::strategies::First<VarPtr>(), options), 724);
+
+    // 3x3 latin squares with rows as tables. The tables keep their state between searches
+    std::vector<VarPtr> vars;
+    for (int i = 0; i < 9; ++i) {
+        vars.emplace_back(std::make_shared<TestVar>(std::list{1, 2, 3}));
+    }
+
+    csp::ConstraintSet<VarPtr> constraints;
+    const std::vector<std::vector<int>> rows{{1, 2, 3}, {1, 3, 2}, {2, 1, 3}, {2, 3, 1}, {3, 1, 2}, {3, 2, 1}};
+    for (std::size_t i = 0; i < 3; ++i) {
+        constraints.add(csp::TableConstraint<VarPtr>({vars[i * 3], vars[i * 3 + 1], vars[i * 3 + 2]}, rows));
+        constraints.add(csp::AllDifferent<VarPtr>({vars[i], vars[i + 3], vars[i + 6]}));
+    }
+
+    auto latin = csp::make_csp(vars, constraints);
+    EXPECT_EQ(csp::countSolutions(latin), 12);
+    EXPECT_EQ(csp::countSolutions(latin, 100, csp::strategies::Mrv<VarPtr>(), options), 12);
+    EXPECT_EQ(csp::countSolutions(latin), 12);
+}
+
+TEST(solver_test, restart_policy) {
+    const std::vector<std::size_t> sequence{1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, 1};
+    for (std::size_t i = 0; i < sequence.size(); ++i) {
+        EXPECT_EQ(csp::util::luby(i + 1), sequence[i]);
+    }
+
+    csp::util::SearchLimit luby(csp::Restarts::Luby, 2, 1.5);
+    std::vector<std::size_t> cutoffs;
+    for (int run = 0; run < 7; ++run) {
+        std::size_t backtracks = 1;
+        while (!luby.onBacktrack()) {
+            ++backtracks;
+        }
+
+        EXPECT_TRUE(luby.interrupted());
+        cutoffs.emplace_back(backtracks);
+        EXPECT_TRUE(luby.restart());
+    }
+
+    EXPECT_EQ(cutoffs, (std::vector<std::size_t>{2, 2, 4, 2, 2, 4, 8}));
+    EXPECT_EQ(luby.restarts(), 7);
+    EXPECT_FALSE(luby.restart());
+    csp::util::SearchLimit geometric(csp::Restarts::Geometric, 10, 2);
+    for (std::size_t cutoff : {10, 20, 40}) {
+        for (std::size_t i = 1; i < cutoff; ++i) {
+            EXPECT_FALSE(geometric.onBacktrack());
+        }
+
+        EXPECT_TRUE(geometric.onBacktrack());
+        EXPECT_TRUE(geometric.restart());
+    }
+
+    csp::util::SearchLimit none(csp::Restarts::None, 1, 1);
+    EXPECT_FALSE(none.onBacktrack());
+    EXPECT_FALSE(none.restart());
+}
+
+TEST(solver_test, restarts) {
+    csp::SolverOptions options;
+    options.restarts = csp::Restarts::Luby;
+    options.restartBase = 1;
+    for (bool backjumping : {false, true}) {
+        options.backjumping = backjumping;
+        auto [queens, constraints] = makeQueens(16);
+        csp::SolveStats stats;
+        ASSERT_TRUE(csp::solve(queens, csp::strategies::Mrv<VarPtr>(3), csp::strategies::RandomValueOrder(3),
+                               options, stats));
+        EXPECT_GT(stats.restarts, 0);
+        expectSolution(constraints);
+
+        // restarts are complete since the cutoffs grow
+        auto [unsolvable, holes] = makePigeonhole(5);
+        stats = {};
+        EXPECT_FALSE(csp::solve(unsolvable, csp::strategies::DomWdeg<VarPtr>(), options, stats));
+        EXPECT_GT(stats.restarts, 0);
+    }
+
+    options.restarts = csp::Restarts::Geometric;
+    auto [queens, constraints] = makeQueens(8);
+    EXPECT_EQ(csp::countSolutions(queens, 1000, csp::strategies::Mrv<VarPtr>(5), options), 92);
+}
+
+TEST(solver_test, limits) {
+    // pigeonhole problems are hard for binary propagation, but arc consistency removes no values
+    auto [problem, problemConstraints] = makePigeonhole(9);
+    csp::SolverOptions options;
+    options.limits.nodes = 100;
+    csp::SolveStats stats;
+    EXPECT_EQ(csp::trySolve(problem, csp::strategies::Mrv<VarPtr>(), csp::strategies::DomainOrder(), options, stats),
+              csp::SolveResult::Aborted);
+    EXPECT_EQ(stats.nodes, 100);
+    EXPECT_FALSE(csp::solve(problem, csp::strategies::Mrv<VarPtr>(), options));
+    for (const auto &var : problem.variables) {
+        EXPECT_EQ(var->valueDomain().size(), 9);
+    }
+
+    options.limits = {};
+    options.limits.propagations = 1000;
+    stats = {};
+    EXPECT_EQ(csp::trySolve(problem, csp::strategies::Mrv<VarPtr>(), csp::strategies::DomainOrder(), options, stats),
+              csp::SolveResult::Aborted);
+    // the revision that triggered the abort is counted as well
+    EXPECT_EQ(stats.arcsRevised, 1001);
+
+    options.limits = {};
+    options.limits.deadline = std::chrono::steady_clock::now();
+    EXPECT_EQ(csp::trySolve(problem, csp::strategies::Mrv<VarPtr>(), options), csp::SolveResult::Aborted);
+
+    options.limits = {};
+    options.limits.cancellation.emplace();
+    const csp::CancellationToken token = *options.limits.cancellation;
+    std::thread canceller([token]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        token.cancel();
+    });
+
+    auto [hard, hardConstraints] = makePigeonhole(12);
+    EXPECT_EQ(csp::trySolve(hard, csp::strategies::First<VarPtr>(), options), csp::SolveResult::Aborted);
+    canceller.join();
+    EXPECT_TRUE(token.cancelled());
+
+    options.limits.cancellation.reset();
+    options.limits.nodes = 100000;
+    auto [small, smallConstraints] = makePigeonhole(4);
+    EXPECT_EQ(csp::trySolve(small, csp::strategies::Mrv<VarPtr>(), options), csp::SolveResult::Unsatisfiable);
+    auto [solvable, solvableConstraints] = makePigeonhole(4);
+    solvable.variables.back()->valueDomain() = {0, 1, 2, 3, 4};
+    EXPECT_EQ(csp::trySolve(solvable, csp::strategies::Mrv<VarPtr>(), options), csp::SolveResult::Solved);
+}
@@ -4,6 +4,8 @@
 
 #include <gtest/gtest.h>
 #include <memory>
+#include <functional>
+#include <set>
 
 #include "TestTypes.h"
 #include "Csp.h"
@@ -19,6 +21,26 @@ TEST(strategies_test, mrv) {
     EXPECT_EQ(next, b);
 }
 
+TEST(strategies_test, random_mrv) {
+    auto a = std::make_shared<TestVar>(std::list{1});
+    auto b = std::make_shared<TestVar>(std::list{1, 2});
+    auto c = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto d = std::make_shared<TestVar>(std::list{1, 2});
+    auto e = std::make_shared<TestVar>(std::list{1, 2});
+    auto problem = csp::make_csp(std::array{a, b, c, d, e}, std::vector<TestArc>{});
+    csp::strategies::Mrv<VarPtr> mrv(42);
+    csp::strategies::Mrv<VarPtr> same(42);
+    std::set<VarPtr> chosen;
+    for (int i = 0; i < 50; ++i) {
+        auto next = mrv(problem);
+        EXPECT_EQ(next, same(problem));
+        EXPECT_EQ(next->valueDomain().size(), 2);
+        chosen.emplace(next);
+    }
+
+    EXPECT_EQ(chosen.size(), 3);
+}
+
 TEST(strategy_test, first) {
     auto a = std::make_shared<TestVar>(std::list{1});
     auto b = std::make_shared<TestVar>(std::list{1, 2});
@@ -27,4 +49,177 @@ TEST(strategy_test, first) {
     auto problem = csp::make_csp(std::array{a, c, d, b}, std::vector<TestArc>{});
     auto next = csp::strategies::First<VarPtr>()(problem);
     EXPECT_EQ(next, c);
-}
\ No newline at end of file
+}
+
+TEST(strategies_test, incremental_mrv) {
+    auto a = std::make_shared<TestVar>(std::list{1});
+    auto b = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto c = std::make_shared<TestVar>(std::list{1, 2});
+    auto d = std::make_shared<TestVar>(std::list{1, 2, 3 , 4});
+    auto problem = csp::make_csp(std::array{a, b, c, d}, std::vector<TestArc>{});
+    csp::strategies::IncrementalMrv<VarPtr> mrv(problem);
+    EXPECT_EQ(mrv(problem), c);
+    c->assign(1);
+    mrv.onDomainChanged(problem, 2);
+    EXPECT_EQ(mrv(problem), b);
+    d->setValueDomain(std::list{3, 4});
+    mrv.onDomainChanged(problem, 3);
+    EXPECT_EQ(mrv(problem), d);
+    c->setValueDomain(std::list{1, 2});
+    d->assign(3);
+    mrv.onDomainChanged(problem, 2);
+    mrv.onDomainChanged(problem, 3);
+    EXPECT_EQ(mrv(problem), c);
+    b->assign(1);
+    c->assign(1);
+    mrv.onDomainChanged(problem, 1);
+    mrv.onDomainChanged(problem, 2);
+    EXPECT_TRUE(mrv(problem)->isAssigned());
+}
+
+TEST(strategies_test, stateful_strategy_trait) {
+    using ProblemT = csp::Csp<VarPtr>;
+    EXPECT_TRUE((csp::type_traits::is_stateful_strategy<csp::strategies::IncrementalMrv<VarPtr>, ProblemT>::value));
+    EXPECT_FALSE((csp::type_traits::is_stateful_strategy<csp::strategies::Mrv<VarPtr>, ProblemT>::value));
+}
+
+TEST(strategies_test, max_degree) {
+    auto a = std::make_shared<TestVar>(std::list{1, 2});
+    auto b = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto c = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto d = std::make_shared<TestVar>(std::list{1, 2});
+    auto problem = csp::make_csp(std::array{a, b, c, d}, std::vector<TestConstraint>{
+        {a, b, std::not_equal_to<>()}, {b, c, std::not_equal_to<>()}, {c, d, std::not_equal_to<>()}});
+    csp::strategies::MaxDegree<VarPtr> strategy;
+    EXPECT_EQ(strategy(problem), b);
+    b->assign(1);
+    EXPECT_EQ(strategy(problem), c);
+    c->assign(2);
+    EXPECT_EQ(strategy(problem), a);
+}
+
+TEST(strategies_test, mrv_degree) {
+    auto a = std::make_shared<TestVar>(std::list{1, 2});
+    auto b = std::make_shared<TestVar>(std::list{1, 2});
+    auto c = std::make_shared<TestVar>(std::list{1, 2});
+    auto d = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto problem = csp::make_csp(std::array{a, b, c, d}, std::vector<TestConstraint>{
+        {a, b, std::not_equal_to<>()}, {b, d, std::not_equal_to<>()}, {c, d, std::not_equal_to<>()},
+        {a, d, std::not_equal_to<>()}});
+    csp::strategies::MrvDegree<VarPtr> strategy;
+    EXPECT_EQ(strategy(problem), a);
+    d->assign(1);
+    EXPECT_EQ(strategy(problem), a);
+    a->assign(1);
+    EXPECT_EQ(strategy(problem), b);
+}
+
+TEST(strategies_test, dom_wdeg) {
+    auto a = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto b = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto c = std::make_shared<TestVar>(std::list{1, 2});
+    auto d = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto problem = csp::make_csp(std::array{a, b, c, d}, std::vector<TestConstraint>{
+        {a, b, std::not_equal_to<>()}, {c, d, std::not_equal_to<>()}});
+    csp::strategies::DomWdeg<VarPtr> strategy(problem);
+    EXPECT_EQ(strategy(problem), c);
+    std::size_t arcAB = problem.incomingArcs(1).front();
+    ASSERT_EQ(problem.arcSources[arcAB], 0);
+    strategy.onConflict(problem, arcAB);
+    strategy.onConflict(problem, arcAB);
+    EXPECT_EQ(strategy.weight(arcAB), 3);
+    EXPECT_EQ(strategy.weight(problem.incomingArcs(0).front()), 3);
+    EXPECT_EQ(strategy(problem), a);
+    b->assign(1);
+    EXPECT_EQ(strategy(problem), c);
+}
+
+TEST(strategies_test, dom_wdeg_parallel_constraints) {
+    // two constraints between the same variables have separate weights
+    auto a = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto b = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto problem = csp::make_csp(std::array{a, b}, std::vector<TestConstraint>{
+        {a, b, std::not_equal_to<>()}, {a, b, std::less_equal<>()}});
+    ASSERT_EQ(problem.arcs.size(), 4);
+    EXPECT_EQ(problem.reverseArcs, (std::vector<std::size_t>{1, 0, 3, 2}));
+    csp::strategies::DomWdeg<VarPtr> strategy(problem);
+    strategy.onConflict(problem, 3);
+    EXPECT_EQ(strategy.weight(0), 1);
+    EXPECT_EQ(strategy.weight(1), 1);
+    EXPECT_EQ(strategy.weight(2), 2);
+    EXPECT_EQ(strategy.weight(3), 2);
+
+    // arcs added on their own have no reverse arc
+    auto arcs = csp::make_csp(std::array{a, b}, std::array{TestArc(a, b, std::less<>()), TestArc(b, a, std::less<>())});
+    EXPECT_EQ(arcs.reverseArcs, (std::vector<std::size_t>(2, csp::Csp<VarPtr>::NoArc)));
+}
+
+TEST(strategies_test, conflict_aware_strategy_trait) {
+    using ProblemT = csp::Csp<VarPtr>;
+    EXPECT_TRUE((csp::type_traits::is_conflict_aware_strategy<csp::strategies::DomWdeg<VarPtr>, ProblemT>::value));
+    EXPECT_TRUE((csp::type_traits::is_stateful_strategy<csp::strategies::DomWdeg<VarPtr>, ProblemT>::value));
+    EXPECT_FALSE((csp::type_traits::is_conflict_aware_strategy<csp::strategies::IncrementalMrv<VarPtr>,
+                  ProblemT>::value));
+}
+
+TEST(strategies_test, least_constraining_value) {
+    auto a = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto b = std::make_shared<TestVar>(std::list{1, 3});
+    auto c = std::make_shared<TestVar>(std::list{1, 2});
+    auto d = std::make_shared<TestVar>(std::list{1});
+    auto problem = csp::make_csp(std::array{a, b, c, d}, std::vector<TestConstraint>{
+        {a, b, std::not_equal_to<>()}, {a, c, std::not_equal_to<>()}, {a, d, std::less<>()}});
+    d->assign(1);
+    std::vector<int> values{1, 2, 3};
+    csp::strategies::LeastConstrainingValue<VarPtr>()(problem, 0, values);
+    EXPECT_EQ(values, (std::vector{2, 3, 1}));
+}
+
+TEST(strategies_test, least_constraining_value_matrix) {
+    auto a = std::make_shared<BitsetVar>(BitsetVar{1, 2, 3});
+    auto b = std::make_shared<BitsetVar>(BitsetVar{1, 3});
+    auto c = std::make_shared<BitsetVar>(BitsetVar{1, 2});
+    auto problem = csp::make_csp(std::array{a, b, c}, std::vector<BitsetConstraint>{
+        {a, b, std::not_equal_to<>()}, {a, c, std::not_equal_to<>()}}, csp::ConstraintMode::Matrix);
+    ASSERT_FALSE(problem.arcSupports.empty());
+    std::vector<int> values{1, 2, 3};
+    csp::strategies::LeastConstrainingValue<BitsetVarPtr>()(problem, 0, values);
+    EXPECT_EQ(values, (std::vector{2, 3, 1}));
+}
+
+TEST(strategies_test, value_comparator) {
+    auto a = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto problem = csp::make_csp(std::array{a}, std::vector<TestArc>{});
+    std::vector<int> values{1, 3, 2};
+    csp::strategies::ValueComparator(std::greater<>())(problem, 0, values);
+    EXPECT_EQ(values, (std::vector{3, 2, 1}));
+}
+
+TEST(strategies_test, random_value_order) {
+    auto a = std::make_shared<TestVar>(std::list{1, 2, 3, 4, 5});
+    auto problem = csp::make_csp(std::array{a}, std::vector<TestArc>{});
+    csp::strategies::RandomValueOrder order(7);
+    csp::strategies::RandomValueOrder same(7);
+    std::set<std::vector<int>> orders;
+    for (int i = 0; i < 20; ++i) {
+        std::vector<int> values{1, 2, 3, 4, 5};
+        std::vector<int> expected = values;
+        order(problem, 0, values);
+        same(problem, 0, expected);
+        EXPECT_EQ(values, expected);
+        orders.emplace(values);
+        std::sort(values.begin(), values.end());
+        EXPECT_EQ(values, (std::vector{1, 2, 3, 4, 5}));
+    }
+
+    EXPECT_GT(orders.size(), 1);
+}
+
+TEST(strategies_test, value_order_trait) {
+    using ProblemT = csp::Csp<VarPtr>;
+    EXPECT_TRUE((csp::type_traits::is_value_order<csp::strategies::DomainOrder, ProblemT>::value));
+    EXPECT_TRUE((csp::type_traits::is_value_order<csp::strategies::LeastConstrainingValue<VarPtr>, ProblemT>::value));
+    EXPECT_TRUE((csp::type_traits::is_value_order<csp::strategies::ValueComparator<std::less<>>, ProblemT>::value));
+    EXPECT_TRUE((csp::type_traits::is_value_order<csp::strategies::RandomValueOrder, ProblemT>::value));
+    EXPECT_FALSE((csp::type_traits::is_value_order<int, ProblemT>::value));
+}
@@ -31,6 +31,16 @@ TEST(util_test, remove_inconsistent_indicate_removal) {
     EXPECT_FALSE(removeInconsistent(a));
 }
 
+TEST(util_test, remove_inconsistent_typed) {
+    using namespace csp::util;
+    auto varA = std::make_shared<TestVar>(std::list{2, 3, 1});
+    auto varB = std::make_shared<TestVar>(std::list{2, 3, 1});
+    csp::Arc<VarPtr, std::less<>> a(varA, varB, std::less<>(), true);
+    EXPECT_TRUE(removeInconsistent(a));
+    EXPECT_EQ(varB->valueDomain(), (std::list{2, 3}));
+    EXPECT_EQ(varA->valueDomain(), (std::list{2, 3, 1}));
+}
+
 TEST(util_test, ac3) {
     using namespace csp;
     using namespace util;
@@ -47,6 +57,23 @@ TEST(util_test, ac3) {
     EXPECT_EQ(varC->valueDomain(), (std::list{2, 3}));
 }
 
+TEST(util_test, ac3_stats) {
+    using namespace csp;
+    using namespace util;
+    auto varA = std::make_shared<TestVar>(std::list{2, 3, 1});
+    auto varB = std::make_shared<TestVar>(std::list{2, 3, 1});
+    auto varC = std::make_shared<TestVar>(std::list{2, 3, 1});
+    Csp problem = make_csp(std::array{varA, varB, varC}, std::array{TestConstraint(varA, varB, std::less<>()),
+                                                                    TestConstraint(varA, varC, std::less<>())});
+    ArcQueue queue(problem.arcs.size());
+    NoTrail trail;
+    SolveStats stats;
+    EXPECT_TRUE(ac3(problem, queue, trail, stats));
+    EXPECT_EQ(stats.ac3Calls, 1);
+    EXPECT_GE(stats.arcsRevised, problem.arcs.size());
+    EXPECT_EQ(stats.valuesPruned, 3);
+}
+
 TEST(util_test, ac3_unsolvable) {
     using namespace csp;
     using namespace util;
@@ -79,4 +106,24 @@ TEST(util_test, csp_checkpoint) {
     for (std::size_t i = 0; i < checkpoint.size(); ++i) {
         EXPECT_EQ(checkpoint[i], problem.variables[i]->valueDomain());
     }
-}
\ No newline at end of file
+}
+TEST(util_test, ac3_from) {
+    using namespace csp;
+    using namespace util;
+    auto varA = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto varB = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto varC = std::make_shared<TestVar>(std::list{1, 2, 3});
+    auto varD = std::make_shared<TestVar>(std::list{1, 2, 3});
+    TestConstraint aNotB(varA, varB, std::not_equal_to<>());
+    TestConstraint bNotC(varB, varC, std::not_equal_to<>());
+    TestConstraint cNotD(varC, varD, std::not_equal_to<>());
+    Csp problem = make_csp(std::array{varA, varB, varC, varD}, std::array{aNotB, bNotC, cNotD});
+    ASSERT_TRUE(ac3(problem));
+    varB->assign(2);
+    varD->assign(3);
+    EXPECT_TRUE(ac3From(problem, std::array{varB, varD}));
+    EXPECT_EQ(varA->valueDomain(), (std::list{1, 3}));
+    EXPECT_EQ(varC->valueDomain(), (std::list{1}));
+    varA->assign(2);
+    EXPECT_FALSE(ac3From(problem, std::array{varA}));
+}
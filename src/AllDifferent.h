@@ -0,0 +1,391 @@
+/**
+ * @file AllDifferent.h
+ * @author Tim Luchterhand
+ * @date 18.10.26
+ * @brief This file contains the csp::AllDifferent global constraint which requires all of its variables to take
+ * pairwise different values. The constraint is filtered using Régin's matching based algorithm which removes every
+ * value that cannot be part of any solution of the constraint (generalized arc consistency). Compared to pairwise
+ * not-equal constraints, this also detects Hall sets, e.g. three variables sharing the same three values.
+ */
+
+#ifndef CSP_SOLVER_ALLDIFFERENT_H
+#define CSP_SOLVER_ALLDIFFERENT_H
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <type_traits>
+
+#include "Variable.h"
+#include "util.h"
+
+namespace csp {
+
+    /**
+     * Global constraint that requires all variables to take pairwise different values. Can be added to a
+     * csp::ConstraintSet
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable. Values must be ordered by operator<
+     */
+    template<typename VarPtr>
+    class AllDifferent {
+    public:
+        using VarT = std::remove_reference_t<decltype(*std::declval<VarPtr>())>;
+        using ValueT = typename VarT::ValueT;
+        using VarListT = std::vector<VarPtr>;
+
+        /**
+         * Ctor
+         * @param variables variables that have to take pairwise different values
+         */
+        explicit AllDifferent(VarListT variables) : vars(std::move(variables)) {}
+
+        /**
+         * Ctor
+         * @tparam VarIt Iterator type of variable container
+         * @param begin start of range of variables
+         * @param end end of range of variables (exclusive)
+         */
+        template<typename VarIt, std::enable_if_t<!std::is_convertible_v<VarIt, VarPtr>, int> = 0>
+        AllDifferent(VarIt begin, VarIt end) : vars(begin, end) {}
+
+        [[nodiscard]] auto variables() const noexcept -> const VarListT & {
+            return vars;
+        }
+
+        /**
+         * Replaces the variables of the constraint, e.g. by their copies in a cloned csp::Csp (see csp::clone)
+         * @param variables new variables in order of variables()
+         */
+        void replaceVariables(const VarListT &variables) {
+            vars = variables;
+        }
+
+        /**
+         * Checks if the constraint is satisfied by the given values
+         * @param values one value for each variable in order of variables()
+         * @return true if all values are pairwise different
+         */
+        [[nodiscard]] static bool satisfied(std::vector<ValueT> values) {
+            std::sort(values.begin(), values.end());
+            return std::adjacent_find(values.begin(), values.end()) == values.end();
+        }
+
+        /**
+         * Removes all values that are not part of a maximum matching between variables and values
+         * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+         * @param trail variables are saved to the trail before their domain is modified
+         * @param changed the position of each modified variable is appended
+         * @return false if no assignment of pairwise different values exists
+         */
+        template<typename TrailT>
+        bool filter(TrailT &trail, std::vector<std::size_t> &changed) {
+            collectValues();
+            if (values.size() < vars.size()) {
+                return false;
+            }
+
+            buildGraph();
+            if (!findMatching()) {
+                return false;
+            }
+
+            findConsistentEdges();
+            for (std::size_t var = 0; var < vars.size(); ++var) {
+                auto &domain = vars[var]->valueDomain();
+                bool removed = false;
+                for (auto it = domain.begin(); it != domain.end();) {
+                    const std::size_t val = valueIndex(*it);
+                    if (valueMatch[val] == var || reachable[valueVertex(val)] ||
+                        component[valueVertex(val)] == component[var]) {
+                        ++it;
+                        continue;
+                    }
+
+                    if (!removed) {
+                        trail.save(vars[var]);
+                        removed = true;
+                    }
+
+                    it = domain.erase(it);
+                }
+
+                if (removed) {
+                    changed.emplace_back(var);
+                }
+            }
+
+            return true;
+        }
+
+    private:
+        static constexpr std::size_t None = std::numeric_limits<std::size_t>::max();
+
+        struct Frame {
+            std::size_t vertex;
+            std::size_t next;
+        };
+
+        /*
+         * Vertices of the value graph are the variables [0, n) followed by the values [n, n + m). Matching edges
+         * point from a variable to its value, all other edges point from a value to a variable
+         */
+        [[nodiscard]] std::size_t valueVertex(std::size_t val) const noexcept {
+            return vars.size() + val;
+        }
+
+        [[nodiscard]] std::size_t valueIndex(const ValueT &val) const {
+            return static_cast<std::size_t>(std::lower_bound(values.begin(), values.end(), val) - values.begin());
+        }
+
+        void collectValues() {
+            values.clear();
+            for (const auto &var : vars) {
+                values.insert(values.end(), std::begin(var->valueDomain()), std::end(var->valueDomain()));
+            }
+
+            std::sort(values.begin(), values.end());
+            values.erase(std::unique(values.begin(), values.end()), values.end());
+        }
+
+        /*
+         * Edges between variables and values in both directions, built once per call of filter, so that the values
+         * are only searched once. The values of variable i are varValues[varOffsets[i]] to varValues[varOffsets[i + 1]]
+         * in domain order and the variables of value j are valueVars[valueOffsets[j]] to valueVars[valueOffsets[j + 1]]
+         */
+        void buildGraph() {
+            varOffsets.assign(1, 0);
+            varValues.clear();
+            valueOffsets.assign(values.size() + 1, 0);
+            for (const auto &var : vars) {
+                for (const auto &value : var->valueDomain()) {
+                    varValues.emplace_back(valueIndex(value));
+                    ++valueOffsets[varValues.back() + 1];
+                }
+
+                varOffsets.emplace_back(varValues.size());
+            }
+
+            for (std::size_t val = 0; val < values.size(); ++val) {
+                valueOffsets[val + 1] += valueOffsets[val];
+            }
+
+            valueVars.resize(varValues.size());
+            insertPos.assign(valueOffsets.begin(), valueOffsets.end() - 1);
+            for (std::size_t var = 0; var < vars.size(); ++var) {
+                for (std::size_t pos = varOffsets[var]; pos < varOffsets[var + 1]; ++pos) {
+                    valueVars[insertPos[varValues[pos]]++] = var;
+                }
+            }
+        }
+
+        /*
+         * Maximum matching using augmenting paths. The matching of the last call is reused as long as the matched
+         * values are still contained in the domains, so that usually only few variables need to be rematched
+         */
+        bool findMatching() {
+            varMatch.assign(vars.size(), None);
+            valueMatch.assign(values.size(), None);
+            lastMatch.resize(vars.size());
+            for (std::size_t var = 0; var < vars.size(); ++var) {
+                if (lastMatch[var].has_value() && util::contains(vars[var]->valueDomain(), *lastMatch[var])) {
+                    const std::size_t val = valueIndex(*lastMatch[var]);
+                    if (valueMatch[val] == None) {
+                        varMatch[var] = val;
+                        valueMatch[val] = var;
+                    }
+                }
+            }
+
+            for (std::size_t var = 0; var < vars.size(); ++var) {
+                if (varMatch[var] != None) {
+                    continue;
+                }
+
+                visited.assign(values.size(), false);
+                if (!augment(var)) {
+                    return false;
+                }
+            }
+
+            for (std::size_t var = 0; var < vars.size(); ++var) {
+                lastMatch[var] = values[varMatch[var]];
+            }
+
+            return true;
+        }
+
+        /*
+         * Depth first search for an augmenting path starting at the given free variable. The frames hold the
+         * variables on the current path, so that deep paths cannot overflow the call stack
+         */
+        bool augment(std::size_t root) {
+            frames.clear();
+            frames.emplace_back(Frame{root, varOffsets[root]});
+            while (!frames.empty()) {
+                Frame &frame = frames.back();
+                if (frame.next == varOffsets[frame.vertex + 1]) {
+                    frames.pop_back();
+                    continue;
+                }
+
+                const std::size_t val = varValues[frame.next++];
+                if (visited[val]) {
+                    continue;
+                }
+
+                visited[val] = true;
+                if (valueMatch[val] != None) {
+                    const std::size_t matched = valueMatch[val];
+                    frames.emplace_back(Frame{matched, varOffsets[matched]});
+                    continue;
+                }
+
+                // each variable on the path takes the value through which the next variable was reached
+                std::size_t free = val;
+                for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+                    const std::size_t previous = varMatch[it->vertex];
+                    varMatch[it->vertex] = free;
+                    valueMatch[free] = it->vertex;
+                    free = previous;
+                }
+
+                return true;
+            }
+
+            return false;
+        }
+
+        /*
+         * Successors of a vertex are enumerated by positions in [successorsBegin, successorsEnd). Positions of the
+         * matched variable of a value are skipped by returning None
+         */
+        [[nodiscard]] std::size_t successorsBegin(std::size_t vertex) const noexcept {
+            return vertex < vars.size() ? 0 : valueOffsets[vertex - vars.size()];
+        }
+
+        [[nodiscard]] std::size_t successorsEnd(std::size_t vertex) const noexcept {
+            return vertex < vars.size() ? 1 : valueOffsets[vertex - vars.size() + 1];
+        }
+
+        [[nodiscard]] std::size_t successor(std::size_t vertex, std::size_t pos) const noexcept {
+            if (vertex < vars.size()) {
+                return valueVertex(varMatch[vertex]);
+            }
+
+            const std::size_t var = valueVars[pos];
+            return var == valueMatch[vertex - vars.size()] ? None : var;
+        }
+
+        /*
+         * An unmatched edge is consistent if it lies on an alternating path starting at a free value or on an
+         * alternating cycle. The former are found by a search from all free values, the latter are exactly the
+         * edges inside a strongly connected component of the value graph
+         */
+        void findConsistentEdges() {
+            const std::size_t numVertices = vars.size() + values.size();
+            reachable.assign(numVertices, false);
+            stack.clear();
+            for (std::size_t val = 0; val < values.size(); ++val) {
+                if (valueMatch[val] == None) {
+                    reachable[valueVertex(val)] = true;
+                    stack.emplace_back(valueVertex(val));
+                }
+            }
+
+            while (!stack.empty()) {
+                const std::size_t vertex = stack.back();
+                stack.pop_back();
+                for (std::size_t pos = successorsBegin(vertex); pos < successorsEnd(vertex); ++pos) {
+                    const std::size_t next = successor(vertex, pos);
+                    if (next != None && !reachable[next]) {
+                        reachable[next] = true;
+                        stack.emplace_back(next);
+                    }
+                }
+            }
+
+            component.assign(numVertices, None);
+            index.assign(numVertices, None);
+            lowLink.assign(numVertices, 0);
+            onStack.assign(numVertices, false);
+            stack.clear();
+            nextIndex = 0;
+            for (std::size_t vertex = 0; vertex < numVertices; ++vertex) {
+                if (index[vertex] == None) {
+                    strongConnect(vertex);
+                }
+            }
+        }
+
+        void discover(std::size_t vertex) {
+            index[vertex] = lowLink[vertex] = nextIndex++;
+            stack.emplace_back(vertex);
+            onStack[vertex] = true;
+            frames.emplace_back(Frame{vertex, successorsBegin(vertex)});
+        }
+
+        // Tarjan's algorithm. The frames replace the recursion, so that long paths cannot overflow the call stack
+        void strongConnect(std::size_t root) {
+            frames.clear();
+            discover(root);
+            while (!frames.empty()) {
+                const std::size_t vertex = frames.back().vertex;
+                if (frames.back().next < successorsEnd(vertex)) {
+                    const std::size_t next = successor(vertex, frames.back().next++);
+                    if (next == None) {
+                        continue;
+                    }
+
+                    if (index[next] == None) {
+                        discover(next);
+                    } else if (onStack[next]) {
+                        lowLink[vertex] = std::min(lowLink[vertex], index[next]);
+                    }
+
+                    continue;
+                }
+
+                if (lowLink[vertex] == index[vertex]) {
+                    std::size_t member;
+                    do {
+                        member = stack.back();
+                        stack.pop_back();
+                        onStack[member] = false;
+                        component[member] = vertex;
+                    } while (member != vertex);
+                }
+
+                frames.pop_back();
+                if (!frames.empty()) {
+                    const std::size_t parent = frames.back().vertex;
+                    lowLink[parent] = std::min(lowLink[parent], lowLink[vertex]);
+                }
+            }
+        }
+
+        VarListT vars;
+        std::vector<std::optional<ValueT>> lastMatch;
+        // buffers reused between calls of filter
+        std::vector<ValueT> values;
+        std::vector<std::size_t> varOffsets;
+        std::vector<std::size_t> varValues;
+        std::vector<std::size_t> valueOffsets;
+        std::vector<std::size_t> valueVars;
+        std::vector<std::size_t> insertPos;
+        std::vector<std::size_t> varMatch;
+        std::vector<std::size_t> valueMatch;
+        std::vector<bool> visited;
+        std::vector<bool> reachable;
+        std::vector<std::size_t> component;
+        std::vector<std::size_t> index;
+        std::vector<std::size_t> lowLink;
+        std::vector<bool> onStack;
+        std::vector<std::size_t> stack;
+        std::vector<Frame> frames;
+        std::size_t nextIndex = 0;
+    };
+}
+
+#endif //CSP_SOLVER_ALLDIFFERENT_H
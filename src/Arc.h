@@ -47,20 +47,29 @@ namespace csp {
          */
         template<typename T>
         struct is_derived_from_var : decltype(implementations::derivedTest(std::declval<std::remove_reference_t<T>*>())) {};
+
+        /**
+         * Value type of the csp::Variable referenced by VarPtr
+         * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+         */
+        template<typename VarPtr>
+        using value_type_t = typename std::remove_reference_t<decltype(*std::declval<VarPtr>())>::ValueT;
     }
 
 
     template<typename T>
     using BinaryPredicate = std::function<bool(const T&, const T&)>;
 
-    template<typename VarPtr>
+    template<typename VarPtr, typename Predicate>
     class Arc;
 
     /**
      * Represents a binary undirected constraint in a constraint satisfaction problem
      * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam Predicate Type of the binary predicate. The default type-erased csp::BinaryPredicate accepts any
+     * callable. Specifying the concrete type (e.g. std::less<>) allows the solver to inline the predicate
      */
-    template<typename VarPtr>
+    template<typename VarPtr, typename Predicate = BinaryPredicate<type_traits::value_type_t<VarPtr>>>
     class Constraint {
     public:
         static_assert(type_traits::is_dereferencable<VarPtr>::value,
@@ -70,7 +79,7 @@ namespace csp {
         using VarType = typename std::remove_reference_t<decltype(*std::declval<VarPtr>())>::ValueT;
     protected:
         static constexpr bool nothrow_construcible = std::is_nothrow_move_constructible_v<VarPtr> &&
-                                                     std::is_nothrow_move_constructible_v<BinaryPredicate < VarType>>;
+                                                     std::is_nothrow_move_constructible_v<Predicate>;
     public:
 
         /**
@@ -79,10 +88,11 @@ namespace csp {
          * @param v2 Pointer-Type to first variable
          * @param predicate Constraint in form of a binary predicate
          */
-        Constraint(VarPtr v1, VarPtr v2, BinaryPredicate <VarType> predicate) noexcept(nothrow_construcible): var1(
+        Constraint(VarPtr v1, VarPtr v2, Predicate predicate) noexcept(nothrow_construcible): var1(
                 std::move(v1)), var2(std::move(v2)), predicate(std::move(predicate)) {}
 
-        using ArcT = Arc<VarPtr>;
+        using ArcT = Arc<VarPtr, Predicate>;
+        using PredicateT = Predicate;
 
         /**
          * Create the two equivalent directed csp::Arcs
@@ -95,22 +105,31 @@ namespace csp {
             return {std::move(normal), std::move(reversed)};
         }
 
+        /**
+         * Gets the constraint predicate
+         * @return binary predicate that is called with values of the first and the second variable
+         */
+        constexpr auto getPredicate() const noexcept -> const Predicate & {
+            return predicate;
+        }
+
     protected:
         VarPtr var1, var2;
-        BinaryPredicate<VarType> predicate;
+        Predicate predicate;
     };
 
     /**
      * Represents a binary constraint as directed arc in a constraint satisfaction problem. Is mainly used during
      * solving to obtain arc consistency
      * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam Predicate Type of the binary predicate (see csp::Constraint)
      * @note Constraints implicitly specify two directed arcs. For example: A constraint A < B is equivalent to
      * two arcs A < B and B > A
      */
-    template<typename VarPtr>
-    class Arc : public Constraint<VarPtr> {
+    template<typename VarPtr, typename Predicate = BinaryPredicate<type_traits::value_type_t<VarPtr>>>
+    class Arc : public Constraint<VarPtr, Predicate> {
     public:
-        using VarType = typename Constraint<VarPtr>::VarType;
+        using VarType = typename Constraint<VarPtr, Predicate>::VarType;
         /**
          * Ctor
          * @param v1 Pointer-Type to first variable
@@ -118,9 +137,9 @@ namespace csp {
          * @param predicate Constraint in form of a binary predicate
          * @param reverse Specifies whether the arc represents v2 -> v1 instead
          */
-        Arc(VarPtr v1, VarPtr v2, BinaryPredicate<VarType> predicate, bool reverse = false)
-            noexcept(Constraint<VarPtr>::nothrow_construcible) :
-            Constraint<VarPtr>(std::move(v1), std::move(v2), std::move(predicate)), reversed(reverse) {}
+        Arc(VarPtr v1, VarPtr v2, Predicate predicate, bool reverse = false)
+            noexcept(Constraint<VarPtr, Predicate>::nothrow_construcible) :
+            Constraint<VarPtr, Predicate>(std::move(v1), std::move(v2), std::move(predicate)), reversed(reverse) {}
 
         /**
          * Reverses the arc (switches from() and to() members)
@@ -129,11 +148,19 @@ namespace csp {
             reversed = !reversed;
         }
 
+        /**
+         * Checks the direction of the arc
+         * @return true if the arc points from the second to the first variable of the constraint
+         */
+        [[nodiscard]] constexpr bool isReversed() const noexcept {
+            return reversed;
+        }
+
         /**
          * Gets the source node of the arc
          * @return Always returns the pointer to the source node of the arc, taking into account if the arc is reversed
          */
-        constexpr VarPtr from() const noexcept {
+        constexpr const VarPtr &from() const noexcept {
             return reversed ? this->var2 : this->var1;
         }
 
@@ -142,7 +169,7 @@ namespace csp {
          * @return Always returns the pointer to the destination node of the arc, taking into account if the arc is
          * reversed
          */
-        constexpr VarPtr to() const noexcept {
+        constexpr const VarPtr &to() const noexcept {
             return reversed ? this->var1 : this->var2;
         }
 
@@ -160,6 +187,19 @@ namespace csp {
     private:
         bool reversed;
     };
+
+    /*
+     * Constraints and arcs created from arbitrary callables use the type-erased csp::BinaryPredicate unless the
+     * predicate type is specified explicitly
+     */
+    template<typename VarPtr, typename Predicate>
+    Constraint(VarPtr, VarPtr, Predicate) -> Constraint<VarPtr>;
+
+    template<typename VarPtr, typename Predicate>
+    Arc(VarPtr, VarPtr, Predicate) -> Arc<VarPtr>;
+
+    template<typename VarPtr, typename Predicate>
+    Arc(VarPtr, VarPtr, Predicate, bool) -> Arc<VarPtr>;
 }
 
 
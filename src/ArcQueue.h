@@ -0,0 +1,103 @@
+/**
+ * @file ArcQueue.h
+ * @author Tim Luchterhand
+ * @date 18.10.26
+ * @brief This file contains the csp::util::ArcQueue class, the worklist used by the AC-3 algorithm. The queue stores
+ * arc indices instead of csp::Arc objects and never contains an arc twice.
+ */
+
+#ifndef CSP_SOLVER_ARCQUEUE_H
+#define CSP_SOLVER_ARCQUEUE_H
+
+#include <vector>
+#include <cassert>
+
+namespace csp::util {
+
+    /**
+     * FIFO queue of arc indices without duplicates. Storage is allocated once on construction, so the same queue
+     * can be reused for many runs of the AC-3 algorithm without allocating.
+     */
+    class ArcQueue {
+    public:
+        /**
+         * Ctor
+         * @param numArcs Number of arcs in the CSP. All pushed indices must be smaller than numArcs
+         */
+        explicit ArcQueue(std::size_t numArcs) : buffer(numArcs), inQueue(numArcs, false) {}
+
+        /**
+         * Appends an arc to the queue. Has no effect if the arc is already enqueued
+         * @param arc index of the arc
+         */
+        void push(std::size_t arc) {
+            assert(arc < inQueue.size());
+            if (inQueue[arc]) {
+                return;
+            }
+
+            inQueue[arc] = true;
+            buffer[tail] = arc;
+            tail = tail + 1 == buffer.size() ? 0 : tail + 1;
+            ++count;
+        }
+
+        /**
+         * Appends all arcs [0, numArcs) to the queue
+         */
+        void pushAll() {
+            for (std::size_t arc = 0; arc < inQueue.size(); ++arc) {
+                push(arc);
+            }
+        }
+
+        /**
+         * Removes the first arc from the queue
+         * @return index of the removed arc
+         * @note queue must not be empty
+         */
+        std::size_t pop() {
+            assert(!empty());
+            std::size_t arc = buffer[head];
+            head = head + 1 == buffer.size() ? 0 : head + 1;
+            --count;
+            inQueue[arc] = false;
+            return arc;
+        }
+
+        /**
+         * Checks whether the given arc is currently enqueued
+         * @param arc index of the arc
+         * @return true if arc is enqueued
+         */
+        [[nodiscard]] bool contains(std::size_t arc) const {
+            return inQueue[arc];
+        }
+
+        /**
+         * Removes all arcs from the queue
+         */
+        void clear() {
+            while (!empty()) {
+                pop();
+            }
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return count == 0;
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept {
+            return count;
+        }
+
+    private:
+        std::vector<std::size_t> buffer;
+        std::vector<bool> inQueue;
+        std::size_t head = 0;
+        std::size_t tail = 0;
+        std::size_t count = 0;
+    };
+}
+
+#endif //CSP_SOLVER_ARCQUEUE_H
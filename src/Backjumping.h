@@ -0,0 +1,420 @@
+/**
+ * @file Backjumping.h
+ * @author Tim Luchterhand
+ * @date 18.10.26
+ * @brief This file contains the csp::util::Backjumping class which implements conflict-directed backjumping (CBJ) and
+ * nogood recording for the backtracking search. For each variable, the decisions that caused the reduction of its value
+ * domain are tracked. When a domain is wiped out, these decisions form the conflict set. Search nodes whose decision is
+ * not part of the conflict set of their subtree are skipped. The conflict sets of exhausted nodes are stored as nogoods
+ * in a bounded store and are propagated during search.
+ */
+
+#ifndef CSP_SOLVER_BACKJUMPING_H
+#define CSP_SOLVER_BACKJUMPING_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <type_traits>
+#include <limits>
+#include <cassert>
+
+#include "Csp.h"
+#include "Trail.h"
+#include "util.h"
+
+namespace csp::util {
+
+    /**
+     * Search without backjumping. Used when csp::SolverOptions::backjumping is disabled
+     */
+    struct NoBackjumping {};
+
+    /**
+     * Bookkeeping of conflict-directed backjumping. Decisions are identified by their level (depth of the trail after
+     * the decision). Sets of decisions are stored as bitsets over levels. The decision sets of the variables are part
+     * of the search state and are saved to the trail
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     */
+    template<typename VarPtr>
+    class Backjumping {
+    public:
+        using VarT = typename Csp<VarPtr>::VarT;
+        using ValueT = typename VarT::ValueT;
+
+        /**
+         * Ctor
+         * @param problem CSP to be solved. Must outlive this object
+         * @param nogoodLimit maximum number of stored nogoods. The oldest nogood is replaced when the store is full.
+         * 0 disables nogood recording
+         */
+        Backjumping(const Csp<VarPtr> &problem, std::size_t nogoodLimit) : problem(problem),
+                numWords((problem.variables.size() + 1 + WordBits - 1) / WordBits),
+                reasons(problem.variables.size() * numWords, 0), stamps(reasons.size(), 0),
+                nodeConflicts((problem.variables.size() + 1) * numWords, 0), failure(numWords, 0),
+                nogoodLimit(nogoodLimit), occurrences(problem.variables.size()) {}
+
+        /**
+         * Records that the revision of an arc removed values from its source. The removal is caused by the decisions
+         * that reduced the domain of the destination
+         * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+         * @param arc index of the revised arc
+         * @param trail modified decision sets are saved to the trail
+         */
+        template<typename TrailT>
+        void explainArc(std::size_t arc, TrailT &trail) {
+            include(trail, problem.arcSources[arc], reasonsOf(problem.arcTargets[arc]));
+        }
+
+        /**
+         * Records that a global constraint removed values from the given variables. The removal is caused by the
+         * decisions that reduced the domains of all variables of the constraint
+         * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+         * @param constraint index of the global constraint
+         * @param changed positions of the modified variables in the scope of the constraint
+         * @param trail modified decision sets are saved to the trail
+         */
+        template<typename TrailT>
+        void explainGlobal(std::size_t constraint, const std::vector<std::size_t> &changed, TrailT &trail) {
+            const auto scope = problem.scope(constraint);
+            unite(buffer, scope);
+            for (std::size_t pos : changed) {
+                include(trail, scope[pos], buffer.data());
+            }
+        }
+
+        /**
+         * Sets the conflict set of a failed propagation
+         * @param conflict queue index of the arc or global constraint that failed (see Propagator::conflictArc)
+         */
+        void explainConflict(std::size_t conflict) {
+            if (conflict < problem.arcs.size()) {
+                const std::size_t vars[] = {problem.arcSources[conflict], problem.arcTargets[conflict]};
+                unite(failure, vars);
+            } else {
+                unite(failure, problem.scope(conflict - problem.arcs.size()));
+            }
+        }
+
+        /**
+         * Starts a search node. Must be called before the first decision of the node
+         * @param depth depth of the trail
+         */
+        void beginNode(std::size_t depth) {
+            std::fill_n(node(depth), numWords, 0);
+        }
+
+        /**
+         * Records the decision var = val. Must be called after the choice point for the decision was opened and the
+         * variable was saved to the trail
+         * @param varId index of the assigned variable
+         * @param val assigned value
+         * @param trail trail of the search
+         */
+        void decide(std::size_t varId, const ValueT &val, Trail<VarPtr> &trail) {
+            const std::size_t level = trail.depth();
+            assert(decisions.size() >= level - 1);
+            decisions.erase(decisions.begin() + static_cast<std::ptrdiff_t>(level - 1), decisions.end());
+            decisions.emplace_back(varId, val);
+            const std::size_t word = varId * numWords + level / WordBits;
+            set(trail, word, reasons[word] | bit(level));
+        }
+
+        /**
+         * Adds the conflict set of the last failure to the conflict set of the node at the given depth
+         * @param depth depth of the node whose decision failed
+         */
+        void onFailure(std::size_t depth) {
+            auto *target = node(depth);
+            for (std::size_t i = 0; i < numWords; ++i) {
+                target[i] |= failure[i];
+            }
+
+            reset(target, depth + 1);
+        }
+
+        /**
+         * Adds all decisions above the given depth to the conflict set of the node. Used if a subtree was not
+         * refuted by propagation, e.g. after a solution was found or the subtree was pruned by a bound
+         * @param depth depth of the node
+         */
+        void failAll(std::size_t depth) {
+            auto *target = node(depth);
+            for (std::size_t level = 1; level <= depth; ++level) {
+                target[level / WordBits] |= bit(level);
+            }
+        }
+
+        /**
+         * Processes the conflict set of an exhausted child node
+         * @param depth depth of the parent node
+         * @return true if the decision of the parent node is not part of the conflict set. Then the remaining values
+         * of the parent node would fail for the same reason and the search jumps back further
+         */
+        bool backjump(std::size_t depth) {
+            const std::size_t level = depth + 1;
+            auto *child = node(level);
+            auto *target = node(depth);
+            if ((child[level / WordBits] & bit(level)) == 0) {
+                std::copy_n(child, numWords, target);
+                return true;
+            }
+
+            for (std::size_t i = 0; i < numWords; ++i) {
+                target[i] |= child[i];
+            }
+
+            reset(target, level);
+            return false;
+        }
+
+        /**
+         * Stores the conflict set of an exhausted node as nogood
+         * @param depth depth of the exhausted node
+         * @return true if a nogood was stored
+         */
+        bool learn(std::size_t depth) {
+            if (nogoodLimit == 0) {
+                return false;
+            }
+
+            NogoodT nogood;
+            const auto *conflict = node(depth);
+            for (std::size_t level = 1; level <= depth; ++level) {
+                if ((conflict[level / WordBits] & bit(level)) != 0) {
+                    nogood.emplace_back(decisions[level - 1]);
+                }
+            }
+
+            if (nogood.empty()) {
+                return false;
+            }
+
+            std::size_t slot = nogoods.size();
+            if (nogoods.size() < nogoodLimit) {
+                nogoods.emplace_back();
+            } else {
+                slot = nextSlot;
+                nextSlot = (nextSlot + 1) % nogoodLimit;
+                for (const auto &[var, val] : nogoods[slot]) {
+                    auto &occ = occurrences[var];
+                    occ.erase(std::find(occ.begin(), occ.end(), slot));
+                }
+            }
+
+            for (const auto &[var, val] : nogood) {
+                occurrences[var].emplace_back(slot);
+            }
+
+            nogoods[slot] = std::move(nogood);
+            return true;
+        }
+
+        /**
+         * Propagates the stored nogoods until a fixpoint is reached. Only nogoods containing a variable modified at
+         * the current choice point are checked. If all but one decision of a nogood hold, the value of the remaining
+         * decision is removed and arc consistency is restored
+         * @tparam PropagatorT Type of the propagator (csp::util::Propagator)
+         * @tparam StatsT Type of the statistics (csp::SolveStats or csp::util::NoStats)
+         * @param propagator propagator of the problem
+         * @param trail trail of the search
+         * @param stats statistics of the propagation are added to stats
+         * @return false if a nogood or the subsequent propagation failed. The conflict set is set accordingly
+         */
+        template<typename PropagatorT, typename StatsT>
+        bool propagate(PropagatorT &propagator, Trail<VarPtr> &trail, StatsT &stats) {
+            if (nogoods.empty()) {
+                return true;
+            }
+
+            bool removed = true;
+            while (removed) {
+                removed = false;
+                modified.clear();
+                trail.forEachSaved([this](std::size_t id) { modified.emplace_back(id); });
+                for (std::size_t var : modified) {
+                    for (std::size_t slot : occurrences[var]) {
+                        std::size_t unitVar = NoVar;
+                        switch (check(slot, unitVar)) {
+                            case State::Conflict:
+                                explainNogood(slot, NoVar);
+                                return false;
+                            case State::Unit:
+                                if (!removeUnit(slot, unitVar, trail)) {
+                                    return false;
+                                }
+
+                                if (!propagator.propagateFrom(unitVar, trail, stats)) {
+                                    explainConflict(propagator.conflictArc());
+                                    return false;
+                                }
+
+                                removed = true;
+                                break;
+                            default:
+                                continue;
+                        }
+
+                        break;
+                    }
+
+                    if (removed) {
+                        break;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * Number of stored nogoods
+         * @return size of the nogood store
+         */
+        [[nodiscard]] std::size_t numNogoods() const noexcept {
+            return nogoods.size();
+        }
+
+    private:
+        static constexpr std::size_t WordBits = 64;
+        static constexpr std::size_t NoVar = std::numeric_limits<std::size_t>::max();
+        using NogoodT = std::vector<std::pair<std::size_t, ValueT>>;
+
+        enum class State {
+            Satisfied, Open, Unit, Conflict
+        };
+
+        static constexpr std::uint64_t bit(std::size_t level) noexcept {
+            return std::uint64_t(1) << (level % WordBits);
+        }
+
+        [[nodiscard]] const std::uint64_t *reasonsOf(std::size_t varId) const noexcept {
+            return reasons.data() + varId * numWords;
+        }
+
+        std::uint64_t *node(std::size_t depth) noexcept {
+            return nodeConflicts.data() + depth * numWords;
+        }
+
+        // removes all levels >= level from the given set
+        void reset(std::uint64_t *levels, std::size_t level) const noexcept {
+            levels[level / WordBits] &= bit(level) - 1;
+            std::fill(levels + level / WordBits + 1, levels + numWords, 0);
+        }
+
+        template<typename TrailT>
+        void set(TrailT &trail, std::size_t word, std::uint64_t value) {
+            if (stamps[word] != trail.choicePoint()) {
+                trail.saveWord(reasons[word]);
+                stamps[word] = trail.choicePoint();
+            }
+
+            reasons[word] = value;
+        }
+
+        template<typename TrailT>
+        void include(TrailT &trail, std::size_t varId, const std::uint64_t *levels) {
+            for (std::size_t i = 0; i < numWords; ++i) {
+                const std::size_t word = varId * numWords + i;
+                if ((reasons[word] | levels[i]) != reasons[word]) {
+                    set(trail, word, reasons[word] | levels[i]);
+                }
+            }
+        }
+
+        template<typename VarIds>
+        void unite(std::vector<std::uint64_t> &target, const VarIds &varIds) const {
+            target.assign(numWords, 0);
+            for (std::size_t var : varIds) {
+                const auto *levels = reasonsOf(var);
+                for (std::size_t i = 0; i < numWords; ++i) {
+                    target[i] |= levels[i];
+                }
+            }
+        }
+
+        // sets the conflict set to the decisions that caused all literals of the nogood except the given variable
+        void explainNogood(std::size_t slot, std::size_t except) {
+            failure.assign(numWords, 0);
+            for (const auto &[var, val] : nogoods[slot]) {
+                if (var == except) {
+                    continue;
+                }
+
+                const auto *levels = reasonsOf(var);
+                for (std::size_t i = 0; i < numWords; ++i) {
+                    failure[i] |= levels[i];
+                }
+            }
+        }
+
+        State check(std::size_t slot, std::size_t &unitVar) const {
+            std::size_t open = 0;
+            for (const auto &[var, val] : nogoods[slot]) {
+                const auto &domain = problem.variables[var]->valueDomain();
+                if (!util::contains(domain, val)) {
+                    return State::Satisfied;
+                }
+
+                if (std::size(domain) > 1) {
+                    unitVar = var;
+                    if (++open > 1) {
+                        return State::Open;
+                    }
+                }
+            }
+
+            return open == 0 ? State::Conflict : State::Unit;
+        }
+
+        // removes the value of the only undecided literal. The removal is caused by the other decisions of the nogood
+        bool removeUnit(std::size_t slot, std::size_t unitVar, Trail<VarPtr> &trail) {
+            explainNogood(slot, unitVar);
+            const auto &nogood = nogoods[slot];
+            const ValueT &value = std::find_if(nogood.begin(), nogood.end(), [unitVar](const auto &literal) {
+                return literal.first == unitVar;
+            })->second;
+            const auto &var = problem.variables[unitVar];
+            auto &domain = var->valueDomain();
+            trail.save(unitVar, var);
+            for (auto it = domain.begin(); it != domain.end(); ++it) {
+                if (*it == value) {
+                    domain.erase(it);
+                    break;
+                }
+            }
+
+            include(trail, unitVar, failure.data());
+            if (domain.empty()) {
+                failure.assign(reasonsOf(unitVar), reasonsOf(unitVar) + numWords);
+                return false;
+            }
+
+            return true;
+        }
+
+        const Csp<VarPtr> &problem;
+        std::size_t numWords;
+        /// decisions that caused the reduction of the domain of each variable, numWords words per variable
+        std::vector<std::uint64_t> reasons;
+        std::vector<std::size_t> stamps;
+        /// conflict set of the open node at each depth, numWords words per depth
+        std::vector<std::uint64_t> nodeConflicts;
+        /// conflict set of the last failure
+        std::vector<std::uint64_t> failure;
+        /// decision of each level
+        NogoodT decisions;
+        std::size_t nogoodLimit;
+        std::vector<NogoodT> nogoods;
+        std::size_t nextSlot = 0;
+        /// nogoods containing each variable
+        std::vector<std::vector<std::size_t>> occurrences;
+        // buffers
+        std::vector<std::uint64_t> buffer;
+        std::vector<std::size_t> modified;
+    };
+}
+
+#endif //CSP_SOLVER_BACKJUMPING_H
@@ -0,0 +1,339 @@
+/**
+ * @file BitsetDomain.h
+ * @author Tim Luchterhand
+ * @date 18.10.26
+ * @brief This file contains the csp::BitsetDomain class, a value domain container for integral values from a fixed
+ * universe [0, N). Values are stored as bits in machine words so that removing values never allocates and domain
+ * operations (size, intersection, emptiness checks) are performed word by word.
+ */
+
+#ifndef CSP_SOLVER_BITSETDOMAIN_H
+#define CSP_SOLVER_BITSETDOMAIN_H
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+
+namespace csp {
+
+    /**
+     * Value domain container that stores integral values of the universe [0, N) in a fixed size bitset. Can be used
+     * as domain type of csp::Variable (see csp::Bitset). Iteration yields the contained values in ascending order.
+     * @tparam T Integral value type
+     * @tparam N Size of the universe. All values must be in the range [0, N)
+     * @note The container behaves like a set: inserting a value that is already contained has no effect
+     */
+    template<typename T, std::size_t N>
+    class BitsetDomain {
+        static_assert(std::is_integral_v<T>, "BitsetDomain can only hold integral values");
+        static_assert(N > 0, "BitsetDomain universe must not be empty");
+    public:
+        using WordT = std::uint64_t;
+        static constexpr std::size_t WordBits = 64;
+        static constexpr std::size_t NumWords = (N + WordBits - 1) / WordBits;
+        using WordArrayT = std::array<WordT, NumWords>;
+        static constexpr std::size_t UniverseSize = N;
+        using value_type = T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T;
+        using const_reference = T;
+
+        /**
+         * Forward iterator over the values contained in a csp::BitsetDomain
+         */
+        class const_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = T;
+
+            constexpr const_iterator() noexcept = default;
+
+            constexpr T operator*() const noexcept {
+                return static_cast<T>(pos);
+            }
+
+            constexpr const_iterator &operator++() noexcept {
+                pos = domain->nextSetBit(pos + 1);
+                return *this;
+            }
+
+            constexpr const_iterator operator++(int) noexcept {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            constexpr bool operator==(const const_iterator &other) const noexcept {
+                return pos == other.pos;
+            }
+
+            constexpr bool operator!=(const const_iterator &other) const noexcept {
+                return pos != other.pos;
+            }
+
+        private:
+            friend class BitsetDomain;
+            constexpr const_iterator(const BitsetDomain *domain, std::size_t pos) noexcept : domain(domain), pos(pos) {}
+            const BitsetDomain *domain = nullptr;
+            std::size_t pos = N;
+        };
+
+        using iterator = const_iterator;
+
+        constexpr BitsetDomain() noexcept = default;
+
+        /**
+         * Ctor using initializer list
+         * @param init values to insert
+         */
+        constexpr BitsetDomain(std::initializer_list<T> init) noexcept {
+            for (T val : init) {
+                insert(val);
+            }
+        }
+
+        /**
+         * Creates a domain from all values in the range [begin, end)
+         * @tparam It Iterator type
+         * @param begin start of range
+         * @param end end of range (exclusive)
+         */
+        template<typename It, typename = decltype(*std::declval<It>(), ++std::declval<It&>())>
+        constexpr BitsetDomain(It begin, It end) {
+            for (; begin != end; ++begin) {
+                insert(*begin);
+            }
+        }
+
+        /**
+         * Creates a domain containing all values of the universe
+         * @return Domain containing [0, N)
+         */
+        static constexpr auto full() noexcept -> BitsetDomain {
+            BitsetDomain ret;
+            for (auto &word : ret.bits) {
+                word = ~WordT(0);
+            }
+
+            ret.bits.back() &= lastWordMask();
+            return ret;
+        }
+
+        [[nodiscard]] constexpr const_iterator begin() const noexcept {
+            return const_iterator(this, nextSetBit(0));
+        }
+
+        [[nodiscard]] constexpr const_iterator end() const noexcept {
+            return const_iterator(this, N);
+        }
+
+        /**
+         * Number of contained values
+         * @return population count of the underlying bitset
+         */
+        [[nodiscard]] constexpr std::size_t size() const noexcept {
+            std::size_t ret = 0;
+            for (WordT word : bits) {
+                ret += static_cast<std::size_t>(__builtin_popcountll(word));
+            }
+
+            return ret;
+        }
+
+        [[nodiscard]] constexpr bool empty() const noexcept {
+            WordT acc = 0;
+            for (WordT word : bits) {
+                acc |= word;
+            }
+
+            return acc == 0;
+        }
+
+        /**
+         * Smallest contained value
+         * @return smallest value
+         * @note domain must not be empty
+         */
+        [[nodiscard]] constexpr T front() const noexcept {
+            assert(!empty());
+            return *begin();
+        }
+
+        [[nodiscard]] constexpr bool contains(T val) const noexcept {
+            auto index = static_cast<std::size_t>(val);
+            return index < N && (bits[index / WordBits] >> (index % WordBits)) & 1u;
+        }
+
+        /**
+         * Inserts a value into the domain
+         * @param val value in range [0, N)
+         */
+        constexpr void insert(T val) noexcept {
+            auto index = static_cast<std::size_t>(val);
+            assert(index < N);
+            bits[index / WordBits] |= WordT(1) << (index % WordBits);
+        }
+
+        /**
+         * Same as insert. Allows usage of std::back_inserter
+         * @param val value in range [0, N)
+         */
+        constexpr void push_back(T val) noexcept {
+            insert(val);
+        }
+
+        /**
+         * Removes a value from the domain
+         * @param val value to remove
+         * @return true if the value was contained, false otherwise
+         */
+        constexpr bool erase(T val) noexcept {
+            auto index = static_cast<std::size_t>(val);
+            if (index >= N) {
+                return false;
+            }
+
+            WordT mask = WordT(1) << (index % WordBits);
+            WordT &word = bits[index / WordBits];
+            bool contained = word & mask;
+            word &= ~mask;
+            return contained;
+        }
+
+        /**
+         * Removes the value at the given position
+         * @param pos iterator to the value
+         * @return iterator to the next value
+         */
+        constexpr const_iterator erase(const_iterator pos) noexcept {
+            assert(pos.domain == this && pos.pos < N);
+            bits[pos.pos / WordBits] &= ~(WordT(1) << (pos.pos % WordBits));
+            return const_iterator(this, nextSetBit(pos.pos + 1));
+        }
+
+        constexpr void clear() noexcept {
+            bits = {};
+        }
+
+        /**
+         * Removes all values that are not contained in other (set intersection). Operates on whole words.
+         * @param other other domain
+         * @return true if this domain was modified, false otherwise
+         */
+        constexpr bool intersect(const BitsetDomain &other) noexcept {
+            WordT changed = 0;
+            for (std::size_t i = 0; i < NumWords; ++i) {
+                WordT next = bits[i] & other.bits[i];
+                changed |= next ^ bits[i];
+                bits[i] = next;
+            }
+
+            return changed != 0;
+        }
+
+        /**
+         * Checks whether this domain and other share at least one value
+         * @param other other domain
+         * @return true if intersection is not empty
+         */
+        [[nodiscard]] constexpr bool intersects(const BitsetDomain &other) const noexcept {
+            WordT acc = 0;
+            for (std::size_t i = 0; i < NumWords; ++i) {
+                acc |= bits[i] & other.bits[i];
+            }
+
+            return acc != 0;
+        }
+
+        /**
+         * Checks whether this domain shares at least one value with the given bitset of the same layout
+         * @param other pointer to NumWords words
+         * @return true if intersection is not empty
+         */
+        [[nodiscard]] constexpr bool intersects(const WordT *other) const noexcept {
+            WordT acc = 0;
+            for (std::size_t i = 0; i < NumWords; ++i) {
+                acc |= bits[i] & other[i];
+            }
+
+            return acc != 0;
+        }
+
+        /**
+         * Direct access to the underlying words. Bit i of the whole array is set iff value i is contained
+         * @return array of words
+         */
+        [[nodiscard]] constexpr auto words() const noexcept -> const WordArrayT & {
+            return bits;
+        }
+
+        constexpr bool operator==(const BitsetDomain &other) const noexcept {
+            return bits == other.bits;
+        }
+
+        constexpr bool operator!=(const BitsetDomain &other) const noexcept {
+            return !(*this == other);
+        }
+
+    private:
+        static constexpr WordT lastWordMask() noexcept {
+            constexpr std::size_t rest = N % WordBits;
+            return rest == 0 ? ~WordT(0) : (WordT(1) << rest) - 1;
+        }
+
+        [[nodiscard]] constexpr std::size_t nextSetBit(std::size_t from) const noexcept {
+            std::size_t wordIndex = from / WordBits;
+            if (wordIndex >= NumWords) {
+                return N;
+            }
+
+            WordT word = bits[wordIndex] & (~WordT(0) << (from % WordBits));
+            while (word == 0) {
+                if (++wordIndex == NumWords) {
+                    return N;
+                }
+
+                word = bits[wordIndex];
+            }
+
+            return wordIndex * WordBits + static_cast<std::size_t>(__builtin_ctzll(word));
+        }
+
+        WordArrayT bits{};
+    };
+
+    /**
+     * Helper to use csp::BitsetDomain as domain type of csp::Variable, e.g. csp::Variable<int, csp::Bitset<64>::Domain>
+     * @tparam N Size of the universe of values
+     */
+    template<std::size_t N>
+    struct Bitset {
+        template<typename T>
+        using Domain = BitsetDomain<T, N>;
+    };
+
+    namespace type_traits {
+        namespace implementations {
+            template<typename T, std::size_t N>
+            std::true_type bitsetDomainTest(const BitsetDomain<T, N> *);
+
+            std::false_type bitsetDomainTest(...);
+        }
+
+        /**
+         * Used to check if type is of template type csp::BitsetDomain
+         * @tparam T Type to be checked
+         */
+        template<typename T>
+        struct is_bitset_domain : decltype(implementations::bitsetDomainTest(std::declval<T*>())) {};
+    }
+}
+
+#endif //CSP_SOLVER_BITSETDOMAIN_H
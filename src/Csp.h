@@ -3,8 +3,9 @@
  * @author Tim Luchterhand
  * @date 25.07.20
  * @brief This file contains the csp::Csp class which represents a complete definition of a constraint satisfaction
- * problem. The class contains a list of Variable pointers, a list of all arcs and a map that specifies incoming arcs
- * of each variable. The csp::Csp should be created using the provided function csp::make_csp.
+ * problem. The class contains a list of Variable pointers, a list of all arcs and the incoming arcs of each variable
+ * in compressed sparse row layout as well as global constraints over arbitrary many variables. The csp::Csp should be
+ * created using the provided function csp::make_csp.
  */
 
 #ifndef CSP_SOLVER_CSP_H
@@ -12,10 +13,18 @@
 
 #include <unordered_map>
 #include <vector>
-#include <deque>
+#include <span>
+#include <stdexcept>
+#include <memory>
+#include <limits>
+#include <cassert>
 
 #include "Variable.h"
 #include "Arc.h"
+#include "BitsetDomain.h"
+#include "SupportMatrix.h"
+#include "revise.h"
+#include "GlobalConstraint.h"
 
 /**
  * @brief Contains all relevant datastructures and functions for defining and solving a constraint satisfaction problem
@@ -24,13 +33,13 @@ namespace csp {
 
     namespace type_traits {
         namespace implementations {
-            template<typename VarPtr>
-            std::true_type arcTest(Arc<VarPtr>);
+            template<typename VarPtr, typename Predicate>
+            std::true_type arcTest(Arc<VarPtr, Predicate>);
 
             std::false_type arcTest(...);
 
-            template<typename VarPtr>
-            std::true_type constraintTest(Constraint<VarPtr>);
+            template<typename VarPtr, typename Predicate>
+            std::true_type constraintTest(Constraint<VarPtr, Predicate>);
 
             std::false_type constraintTest(...);
         }
@@ -55,8 +64,21 @@ namespace csp {
     }
 
 
+    namespace implementations {
+        struct CspFactory;
+    }
+
+    template<typename VarPtr>
+    class ConstraintSet;
+
     /**
-     * Represents a constraint satisfaction problem (CSP)
+     * Represents a constraint satisfaction problem (CSP). Apart from the variables and arcs, the problem stores
+     * an index based representation of the constraint graph: Variables and arcs are identified by their position in
+     * variables and arcs respectively. Arcs are stored with the type-erased csp::BinaryPredicate. Each arc has a
+     * csp::util::ArcReviser that evaluates the original predicate type during propagation. Global constraints are
+     * identified by their position in globalConstraints. In the propagation queue, global constraint i has index
+     * arcs.size() + i. A csp::Csp cannot be copied, since a copy would share the variables and the internal state of
+     * the global constraints with the original. Use csp::clone to create an independent copy.
      * @tparam VarPtr VarPtr Pointer-type to a type derived from csp::Variable
      */
     template<typename VarPtr>
@@ -64,20 +86,450 @@ namespace csp {
         using ArcT = Arc<VarPtr>;
         using VarT = std::remove_reference_t<decltype(*std::declval<VarPtr>())>;
         using VarListT = std::vector<VarPtr>;
-        using ArcListT = std::deque<ArcT>;
-        using NeighbourListT = std::unordered_map<VarPtr, std::vector<ArcT>>;
+        using ArcListT = std::vector<ArcT>;
+        using IndexListT = std::vector<std::size_t>;
+        using SupportMatrixT = SupportMatrix<typename VarT::ValueT>;
+        using ReviserListT = std::vector<util::ArcReviser<VarPtr>>;
+        using GlobalListT = std::vector<GlobalConstraint<VarPtr>>;
+        /// entry of reverseArcs for arcs that were added without their reverse direction
+        static constexpr std::size_t NoArc = std::numeric_limits<std::size_t>::max();
+
+    private:
+        /**
+         * Parts of the problem that do not refer to the variables. They are never modified and shared between a csp
+         * and its copies (see csp::clone)
+         */
+        struct Structure {
+            ReviserListT arcRevisers;
+            IndexListT arcSources;
+            IndexListT arcTargets;
+            IndexListT reverseArcs;
+            IndexListT incomingOffsets;
+            IndexListT incomingArcIds;
+            std::vector<SupportMatrixT> supportMatrices;
+            std::vector<ArcSupport> arcSupports;
+            IndexListT scopeOffsets;
+            IndexListT scopeVarIds;
+            IndexListT globalOffsets;
+            IndexListT globalIds;
+        };
+
+        std::shared_ptr<const Structure> structure;
+
+    public:
         const VarListT variables;
         const ArcListT arcs;
-        const NeighbourListT incomingNeighbours;
+        /// revision function of each arc
+        const ReviserListT &arcRevisers;
+        /// maps each variable to its index in variables
+        const std::unordered_map<VarPtr, std::size_t> varIds;
+        /// index of the source variable of each arc
+        const IndexListT &arcSources;
+        /// index of the destination variable of each arc
+        const IndexListT &arcTargets;
+        /// index of the other direction of the same csp::Constraint for each arc, NoArc if there is none
+        const IndexListT &reverseArcs;
+        /// incoming arcs of variable i are incomingArcIds[incomingOffsets[i]] to incomingArcIds[incomingOffsets[i + 1]]
+        const IndexListT &incomingOffsets;
+        /// indices of the incoming arcs of all variables, grouped by destination variable
+        const IndexListT &incomingArcIds;
+        /// compiled constraints (only if created with csp::ConstraintMode::Matrix)
+        const std::vector<SupportMatrixT> &supportMatrices;
+        /// support matrix of each arc. Empty if the constraints are not compiled
+        const std::vector<ArcSupport> &arcSupports;
+        /// constraints over arbitrary many variables
+        const GlobalListT globalConstraints;
+        /// variables of global constraint i are scopeVarIds[scopeOffsets[i]] to scopeVarIds[scopeOffsets[i + 1]]
+        const IndexListT &scopeOffsets;
+        /// indices of the variables of all global constraints in order of GlobalConstraint::variables()
+        const IndexListT &scopeVarIds;
+        /// global constraints of variable i are globalIds[globalOffsets[i]] to globalIds[globalOffsets[i + 1]]
+        const IndexListT &globalOffsets;
+        /// indices of the global constraints of all variables, grouped by variable
+        const IndexListT &globalIds;
+
+        /**
+         * Gets the incoming arcs of a variable
+         * @param varId index of the variable
+         * @return indices of all arcs whose destination is the given variable in ascending order
+         */
+        [[nodiscard]] auto incomingArcs(std::size_t varId) const noexcept -> std::span<const std::size_t> {
+            assert(varId + 1 < incomingOffsets.size());
+            return {incomingArcIds.data() + incomingOffsets[varId], incomingArcIds.data() + incomingOffsets[varId + 1]};
+        }
+
+        /**
+         * Gets the variables of a global constraint
+         * @param constraintId index of the global constraint
+         * @return indices of the variables in order of GlobalConstraint::variables()
+         */
+        [[nodiscard]] auto scope(std::size_t constraintId) const noexcept -> std::span<const std::size_t> {
+            assert(constraintId + 1 < scopeOffsets.size());
+            return {scopeVarIds.data() + scopeOffsets[constraintId],
+                    scopeVarIds.data() + scopeOffsets[constraintId + 1]};
+        }
+
+        /**
+         * Gets the global constraints of a variable
+         * @param varId index of the variable
+         * @return indices of all global constraints containing the given variable in ascending order
+         */
+        [[nodiscard]] auto globalsOf(std::size_t varId) const noexcept -> std::span<const std::size_t> {
+            assert(varId + 1 < globalOffsets.size());
+            return {globalIds.data() + globalOffsets[varId], globalIds.data() + globalOffsets[varId + 1]};
+        }
+
+        /**
+         * Number of entries of the propagation queue: all arcs followed by all global constraints
+         * @return arcs.size() + globalConstraints.size()
+         */
+        [[nodiscard]] std::size_t queueSize() const noexcept {
+            return arcs.size() + globalConstraints.size();
+        }
+
+        Csp(const Csp &) = delete;
+        Csp(Csp &&) = default;
+
+    private:
+        friend struct implementations::CspFactory;
+
+        Csp(VarListT variables, ArcListT arcs, std::unordered_map<VarPtr, std::size_t> varIds,
+            GlobalListT globalConstraints, std::shared_ptr<const Structure> structure) :
+                structure(std::move(structure)), variables(std::move(variables)), arcs(std::move(arcs)),
+                arcRevisers(this->structure->arcRevisers), varIds(std::move(varIds)),
+                arcSources(this->structure->arcSources), arcTargets(this->structure->arcTargets),
+                reverseArcs(this->structure->reverseArcs), incomingOffsets(this->structure->incomingOffsets),
+                incomingArcIds(this->structure->incomingArcIds), supportMatrices(this->structure->supportMatrices),
+                arcSupports(this->structure->arcSupports), globalConstraints(std::move(globalConstraints)),
+                scopeOffsets(this->structure->scopeOffsets), scopeVarIds(this->structure->scopeVarIds),
+                globalOffsets(this->structure->globalOffsets), globalIds(this->structure->globalIds) {}
+    };
+
+    namespace implementations {
+        /**
+         * Creates csp::Csp instances. Use csp::make_csp
+         */
+        struct CspFactory {
+            /**
+             * Creates the CSP from the given variables and arcs
+             * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+             * @param vars all variables
+             * @param arcs all arcs
+             * @param revisers revision function of each arc
+             * @param globals global constraints
+             * @param mode representation of the constraints
+             * @param paired if true, arcs 2k and 2k + 1 are the two directions of the same csp::Constraint
+             * @return csp::Csp
+             */
+            template<typename VarPtr>
+            static auto build(typename Csp<VarPtr>::VarListT vars, typename Csp<VarPtr>::ArcListT arcs,
+                              typename Csp<VarPtr>::ReviserListT revisers, typename Csp<VarPtr>::GlobalListT globals,
+                              ConstraintMode mode, bool paired) -> Csp<VarPtr> {
+                assert(arcs.size() == revisers.size());
+                using CspT = Csp<VarPtr>;
+                using IndexListT = typename CspT::IndexListT;
+                std::unordered_map<VarPtr, std::size_t> varIds;
+                IndexListT arcSources, arcTargets;
+                varIds.reserve(vars.size());
+                for (std::size_t i = 0; i < vars.size(); ++i) {
+                    varIds.emplace(vars[i], i);
+                }
+
+                auto getId = [&varIds](const VarPtr &var) {
+                    auto it = varIds.find(var);
+                    if (it == varIds.end()) {
+                        throw std::invalid_argument("Constraint refers to a variable that is not part of the CSP");
+                    }
+
+                    return it->second;
+                };
+
+                arcSources.reserve(arcs.size());
+                arcTargets.reserve(arcs.size());
+                IndexListT incomingOffsets(vars.size() + 1, 0);
+                for (const auto &arc : arcs) {
+                    arcSources.emplace_back(getId(arc.from()));
+                    arcTargets.emplace_back(getId(arc.to()));
+                    ++incomingOffsets[arcTargets.back() + 1];
+                }
+
+                // counting sort of the arcs by destination variable
+                for (std::size_t i = 0; i < vars.size(); ++i) {
+                    incomingOffsets[i + 1] += incomingOffsets[i];
+                }
+
+                // both directions of a constraint are added next to each other
+                IndexListT reverseArcs(arcs.size(), CspT::NoArc);
+                for (std::size_t i = 0; paired && i + 1 < arcs.size(); i += 2) {
+                    reverseArcs[i] = i + 1;
+                    reverseArcs[i + 1] = i;
+                }
+
+                IndexListT incomingArcIds(arcs.size());
+                IndexListT insertPos(incomingOffsets.begin(), incomingOffsets.end() - 1);
+                for (std::size_t i = 0; i < arcs.size(); ++i) {
+                    incomingArcIds[insertPos[arcTargets[i]]++] = i;
+                }
+
+                IndexListT scopeOffsets(1, 0), scopeVarIds, globalOffsets(vars.size() + 1, 0);
+                for (const auto &global : globals) {
+                    for (const auto &var : global.variables()) {
+                        scopeVarIds.emplace_back(getId(var));
+                        ++globalOffsets[scopeVarIds.back() + 1];
+                    }
+
+                    scopeOffsets.emplace_back(scopeVarIds.size());
+                }
+
+                for (std::size_t i = 0; i < vars.size(); ++i) {
+                    globalOffsets[i + 1] += globalOffsets[i];
+                }
+
+                IndexListT globalIds(scopeVarIds.size());
+                insertPos.assign(globalOffsets.begin(), globalOffsets.end() - 1);
+                for (std::size_t g = 0; g < globals.size(); ++g) {
+                    for (std::size_t pos = scopeOffsets[g]; pos < scopeOffsets[g + 1]; ++pos) {
+                        globalIds[insertPos[scopeVarIds[pos]]++] = g;
+                    }
+                }
+
+                std::vector<typename CspT::SupportMatrixT> matrices;
+                std::vector<ArcSupport> arcSupports;
+                if (mode == ConstraintMode::Matrix) {
+                    compileSupports<VarPtr>(arcs, revisers, paired, matrices, arcSupports);
+                }
+
+                auto structure = std::make_shared<const typename CspT::Structure>(typename CspT::Structure{
+                        std::move(revisers), std::move(arcSources), std::move(arcTargets), std::move(reverseArcs),
+                        std::move(incomingOffsets), std::move(incomingArcIds), std::move(matrices),
+                        std::move(arcSupports), std::move(scopeOffsets), std::move(scopeVarIds),
+                        std::move(globalOffsets), std::move(globalIds)});
+                return CspT(std::move(vars), std::move(arcs), std::move(varIds), std::move(globals),
+                            std::move(structure));
+            }
+
+            /**
+             * Creates the CSP from the given variables and constraints
+             * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+             * @param vars all variables
+             * @param constraints all constraints
+             * @param mode representation of the constraints
+             * @return csp::Csp
+             */
+            template<typename VarPtr>
+            static auto build(typename Csp<VarPtr>::VarListT vars, ConstraintSet<VarPtr> constraints,
+                              ConstraintMode mode) -> Csp<VarPtr> {
+                return build<VarPtr>(std::move(vars), std::move(constraints.arcs), std::move(constraints.revisers),
+                                     std::move(constraints.globals), mode, true);
+            }
+
+            /**
+             * Adds both directions of a constraint
+             * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+             * @tparam Predicate Type of the constraint predicate
+             * @param constraint constraint to add
+             * @param arcs arcs of the CSP
+             * @param revisers revision functions of the CSP
+             */
+            template<typename VarPtr, typename Predicate>
+            static void addConstraint(const Constraint<VarPtr, Predicate> &constraint,
+                                      typename Csp<VarPtr>::ArcListT &arcs,
+                                      typename Csp<VarPtr>::ReviserListT &revisers) {
+                // both directions share one copy of the predicate
+                auto reviser = makeReviser<VarPtr>(constraint.getPredicate());
+                auto [normal, reverse] = constraint.getArcs();
+                arcs.emplace_back(eraseArc(normal));
+                arcs.emplace_back(eraseArc(reverse));
+                revisers.emplace_back(reviser);
+                revisers.emplace_back(std::move(reviser));
+            }
+
+            /**
+             * Adds a single arc
+             * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+             * @tparam Predicate Type of the constraint predicate
+             * @param arc arc to add
+             * @param arcs arcs of the CSP
+             * @param revisers revision functions of the CSP
+             */
+            template<typename VarPtr, typename Predicate>
+            static void addArc(const Arc<VarPtr, Predicate> &arc, typename Csp<VarPtr>::ArcListT &arcs,
+                               typename Csp<VarPtr>::ReviserListT &revisers) {
+                arcs.emplace_back(eraseArc(arc));
+                revisers.emplace_back(makeReviser<VarPtr>(arc.getPredicate()));
+            }
+
+            /**
+             * Creates a copy of the CSP that refers to copies of the variables. Arcs and global constraints are
+             * copied. The revision functions, index structures and compiled constraints are immutable and shared with
+             * the original
+             * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+             * @tparam CopyVar Type of the variable copy function
+             * @param problem CSP to be copied
+             * @param copyVar called once with each variable of the problem, returns an independent copy
+             * @return csp::Csp
+             */
+            template<typename VarPtr, typename CopyVar>
+            static auto clone(const Csp<VarPtr> &problem, CopyVar &&copyVar) -> Csp<VarPtr> {
+                using CspT = Csp<VarPtr>;
+                typename CspT::VarListT vars;
+                std::unordered_map<VarPtr, std::size_t> varIds;
+                vars.reserve(problem.variables.size());
+                varIds.reserve(problem.variables.size());
+                for (const auto &var : problem.variables) {
+                    vars.emplace_back(copyVar(var));
+                    varIds.emplace(vars.back(), vars.size() - 1);
+                }
+
+                typename CspT::ArcListT arcs;
+                arcs.reserve(problem.arcs.size());
+                for (std::size_t i = 0; i < problem.arcs.size(); ++i) {
+                    const auto &arc = problem.arcs[i];
+                    const VarPtr &from = vars[problem.arcSources[i]];
+                    const VarPtr &to = vars[problem.arcTargets[i]];
+                    arcs.emplace_back(arc.isReversed() ? to : from, arc.isReversed() ? from : to, arc.getPredicate(),
+                                      arc.isReversed());
+                }
+
+                typename CspT::GlobalListT globals;
+                globals.reserve(problem.globalConstraints.size());
+                for (std::size_t g = 0; g < problem.globalConstraints.size(); ++g) {
+                    typename CspT::VarListT scope;
+                    for (std::size_t var : problem.scope(g)) {
+                        scope.emplace_back(vars[var]);
+                    }
+
+                    globals.emplace_back(problem.globalConstraints[g].clone(std::move(scope)));
+                }
+
+                return CspT(std::move(vars), std::move(arcs), std::move(varIds), std::move(globals), problem.structure);
+            }
+
+        private:
+            template<typename VarPtr, typename Predicate>
+            static auto makeReviser(const Predicate &predicate) -> util::ArcReviser<VarPtr> {
+                if constexpr (std::is_same_v<Predicate, typename Csp<VarPtr>::ArcT::PredicateT>) {
+                    (void) predicate;
+                    return util::ArcReviser<VarPtr>::erased();
+                } else {
+                    return util::ArcReviser<VarPtr>::typed(std::make_shared<const Predicate>(predicate));
+                }
+            }
+
+            template<typename VarPtr, typename Predicate>
+            static auto eraseArc(const Arc<VarPtr, Predicate> &arc) -> typename Csp<VarPtr>::ArcT {
+                if constexpr (std::is_same_v<Predicate, typename Csp<VarPtr>::ArcT::PredicateT>) {
+                    return arc;
+                } else {
+                    // arcs store the variables in constraint order
+                    const bool reversed = arc.isReversed();
+                    const VarPtr &v1 = reversed ? arc.to() : arc.from();
+                    const VarPtr &v2 = reversed ? arc.from() : arc.to();
+                    return typename Csp<VarPtr>::ArcT(v1, v2, arc.getPredicate(), reversed);
+                }
+            }
+
+            template<typename VarPtr>
+            static void compileSupports(const typename Csp<VarPtr>::ArcListT &arcs,
+                                        const typename Csp<VarPtr>::ReviserListT &revisers, bool paired,
+                                        std::vector<typename Csp<VarPtr>::SupportMatrixT> &matrices,
+                                        std::vector<ArcSupport> &arcSupports) {
+                using DomainT = typename Csp<VarPtr>::VarT::DomainT;
+                using ValueT = typename Csp<VarPtr>::VarT::ValueT;
+                if constexpr (std::is_integral_v<ValueT>) {
+                    using MatrixT = typename Csp<VarPtr>::SupportMatrixT;
+                    auto universe = [](const DomainT &domain) {
+                        if constexpr (type_traits::is_bitset_domain<DomainT>::value) {
+                            // rows have the same layout as the domain's bitset
+                            return typename MatrixT::Universe{0, DomainT::UniverseSize};
+                        } else {
+                            return MatrixT::Universe::of(domain);
+                        }
+                    };
+
+                    const std::size_t step = paired ? 2 : 1;
+                    matrices.reserve(arcs.size() / step);
+                    arcSupports.reserve(arcs.size());
+                    for (std::size_t i = 0; i < arcs.size(); i += step) {
+                        const auto &arc = arcs[i];
+                        const auto &reviser = revisers[i];
+                        const DomainT &d1 = arc.from()->valueDomain();
+                        const DomainT &d2 = arc.to()->valueDomain();
+                        matrices.emplace_back(universe(d1), universe(d2), d1, d2,
+                                              [&arc, &reviser](const ValueT &a, const ValueT &b) {
+                                                  return reviser.satisfied(arc, a, b);
+                                              });
+                        arcSupports.emplace_back(ArcSupport{matrices.size() - 1, false});
+                        if (paired) {
+                            arcSupports.emplace_back(ArcSupport{matrices.size() - 1, true});
+                        }
+                    }
+                } else {
+                    (void) arcs, (void) revisers, (void) paired, (void) matrices, (void) arcSupports;
+                    throw std::invalid_argument("Support matrices require integral values");
+                }
+            }
+        };
+    }
 
-        template<typename VarIt, typename ArcIt, std::enable_if_t<type_traits::is_arc<
-                std::remove_reference_t<decltype(*std::declval<ArcIt>())>>::value, int>>
-        friend auto make_csp(VarIt vBegin, VarIt vEnd, ArcIt aBegin, ArcIt aEnd)
-        -> Csp<std::decay_t<decltype(*++aBegin, aBegin == aEnd, ++vBegin, vBegin == vEnd, *vBegin)>>;
+    /**
+     * Collection of csp::Constraints whose predicates may have different types. Allows to create a csp::Csp from
+     * constraints with concrete predicate types (e.g. std::less<> and a lambda) without falling back to
+     * csp::BinaryPredicate during propagation. Global constraints like csp::AllDifferent can be added as well
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     */
+    template<typename VarPtr>
+    class ConstraintSet {
+    public:
+        /**
+         * Adds a constraint to the set
+         * @tparam Predicate Type of the constraint predicate
+         * @param constraint constraint to add
+         */
+        template<typename Predicate>
+        void add(const Constraint<VarPtr, Predicate> &constraint) {
+            implementations::CspFactory::addConstraint(constraint, arcs, revisers);
+        }
+
+        /**
+         * Creates a constraint in place
+         * @tparam Predicate Type of the constraint predicate
+         * @param v1 Pointer-Type to first variable
+         * @param v2 Pointer-Type to second variable
+         * @param predicate Constraint in form of a binary predicate
+         */
+        template<typename Predicate>
+        void emplace(VarPtr v1, VarPtr v2, Predicate predicate) {
+            add(Constraint<VarPtr, Predicate>(std::move(v1), std::move(v2), std::move(predicate)));
+        }
+
+        /**
+         * Adds a global constraint to the set
+         * @tparam Global Type of the global constraint (see csp::type_traits::is_global_constraint)
+         * @param constraint constraint to add
+         */
+        template<typename Global, std::enable_if_t<type_traits::is_global_constraint<Global>::value, int> = 0>
+        void add(Global constraint) {
+            globals.emplace_back(std::move(constraint));
+        }
+
+        /**
+         * Number of constraints in the set
+         * @return number of binary and global constraints
+         */
+        [[nodiscard]] std::size_t size() const noexcept {
+            return arcs.size() / 2 + globals.size();
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return arcs.empty() && globals.empty();
+        }
 
     private:
-        Csp(VarListT variables, ArcListT arcs, NeighbourListT neighbours) :
-                variables(std::move(variables)), arcs(std::move(arcs)), incomingNeighbours(std::move(neighbours)) {}
+        friend struct implementations::CspFactory;
+        typename Csp<VarPtr>::ArcListT arcs;
+        typename Csp<VarPtr>::ReviserListT revisers;
+        typename Csp<VarPtr>::GlobalListT globals;
     };
 
     /**
@@ -86,6 +538,8 @@ namespace csp {
      * @tparam ArcContainer Container-Type containing csp::Arcs
      * @param variables Container of all variables in the CSP
      * @param arcs Container of all directed csp::Arcs in the CSP
+     * @param mode Representation of the constraints. csp::ConstraintMode::Matrix evaluates each arc for all value
+     * pairs once and stores the result in a csp::SupportMatrix
      * @return csp::Csp representing the problem induced by the given variables and arcs
      * @note When using csp::Arcs to specify the constraints, make sure that if you have a constraint e.g. A < B,
      * you specify both csp::Arcs representing A < B and B > A! Otherwise the problem is malformed and may lead to
@@ -94,12 +548,13 @@ namespace csp {
     template<typename VarContainer, typename ArcContainer, std::enable_if_t<
             type_traits::is_arc<std::remove_reference_t<decltype(*std::begin(std::declval<ArcContainer>()))>>::value,
             int> = 0>
-    auto make_csp(const VarContainer &variables, const ArcContainer &arcs) -> Csp<std::decay_t<decltype(
+    auto make_csp(const VarContainer &variables, const ArcContainer &arcs,
+                  ConstraintMode mode = ConstraintMode::Predicate) -> Csp<std::decay_t<decltype(
                     std::end(arcs),
                     std::end(variables),
                     *std::begin(variables)
             )>> {
-        return make_csp(std::begin(variables), std::end(variables), std::begin(arcs), std::end(arcs));
+        return make_csp(std::begin(variables), std::end(variables), std::begin(arcs), std::end(arcs), mode);
     }
     /**
      * Creates a CSP from a container of variable-pointers and a container of csp::Constraints
@@ -107,6 +562,8 @@ namespace csp {
      * @tparam ArcContainer Container-Type containing csp::Constraints
      * @param variables Container of all variables in the CSP
      * @param arcs Container of all undirected csp::Constraints in the CSP
+     * @param mode Representation of the constraints. csp::ConstraintMode::Matrix evaluates each constraint for all
+     * value pairs once and stores the result in a csp::SupportMatrix that is shared by both directions
      * @return csp::Csp representing the problem induced by the given variables and constraints
      * @note When using csp::Constraints to specify the constraints, specify them only once. A csp::Constraint for
      * e.g. A < B fully represents the constraint between the csp::Variable A and B. Specifying A < B and B > A
@@ -114,12 +571,33 @@ namespace csp {
      */
     template<typename VarContainer, typename ContraintContainer, std::enable_if_t<type_traits::is_constraint<
             std::remove_reference_t<decltype(*std::begin(std::declval<ContraintContainer>()))>>::value, int> = 0>
-    auto make_csp(const VarContainer &variables, const ContraintContainer &constraints) -> Csp<std::decay_t<decltype(
+    auto make_csp(const VarContainer &variables, const ContraintContainer &constraints,
+                  ConstraintMode mode = ConstraintMode::Predicate) -> Csp<std::decay_t<decltype(
                     std::end(constraints),
                     std::end(variables),
                     *std::begin(variables)
             )>> {
-        return make_csp(std::begin(variables), std::end(variables), std::begin(constraints), std::end(constraints));
+        return make_csp(std::begin(variables), std::end(variables), std::begin(constraints), std::end(constraints),
+                        mode);
+    }
+
+    /**
+     * Creates a CSP from a container of variable-pointers and a csp::ConstraintSet
+     * @tparam VarContainer Container-Type containing pointer-types to a type derived of csp::Variable
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @param variables Container of all variables in the CSP
+     * @param constraints all undirected csp::Constraints in the CSP
+     * @param mode Representation of the constraints. csp::ConstraintMode::Matrix evaluates each constraint for all
+     * value pairs once and stores the result in a csp::SupportMatrix that is shared by both directions
+     * @return csp::Csp representing the problem induced by the given variables and constraints
+     * @throws std::invalid_argument if a constraint refers to a variable that is not in the container of variables or
+     * if mode is csp::ConstraintMode::Matrix and the variables do not have integral values
+     */
+    template<typename VarContainer, typename VarPtr>
+    auto make_csp(const VarContainer &variables, ConstraintSet<VarPtr> constraints,
+                  ConstraintMode mode = ConstraintMode::Predicate) -> Csp<VarPtr> {
+        typename Csp<VarPtr>::VarListT vars(std::begin(variables), std::end(variables));
+        return implementations::CspFactory::build<VarPtr>(std::move(vars), std::move(constraints), mode);
     }
 
     /**
@@ -131,27 +609,31 @@ namespace csp {
      * @param vEnd end of range of variables (exclusive)
      * @param cBegin start of range of constraints
      * @param cEnd start of range of constraints (exclusive)
+     * @param mode Representation of the constraints. csp::ConstraintMode::Matrix evaluates each constraint for all
+     * value pairs once and stores the result in a csp::SupportMatrix that is shared by both directions
      * @return csp::Csp representing the problem induced by the given variables and constraints
+     * @throws std::invalid_argument if a constraint refers to a variable that is not in the range of variables or if
+     * mode is csp::ConstraintMode::Matrix and the variables do not have integral values
      * @note When using csp::Constraints to specify the constraints, specify them only once. A csp::Constraint for
      * e.g. A < B fully represents the constraint between the csp::Variable A and B. Specifying A < B and B > A
      * may lead to performance loss during search!
      */
     template<typename VarIt, typename ConstrIt, std::enable_if_t<type_traits::is_constraint<
             std::remove_reference_t<decltype(*std::declval<ConstrIt>())>>::value, int> = 0>
-    auto make_csp(VarIt vBegin, VarIt vEnd, ConstrIt cBegin, ConstrIt cEnd)
+    auto make_csp(VarIt vBegin, VarIt vEnd, ConstrIt cBegin, ConstrIt cEnd,
+                  ConstraintMode mode = ConstraintMode::Predicate)
     -> Csp<std::decay_t<decltype(*++cBegin, cBegin == cEnd, ++vBegin, vBegin == vEnd, *vBegin)>> {
         using VarPtr = std::decay_t<decltype(*vBegin)>;
-        using ArcT = typename Csp<VarPtr>::ArcT;
-        std::vector<ArcT> arcs;
+        typename Csp<VarPtr>::VarListT vars(vBegin, vEnd);
+        typename Csp<VarPtr>::ArcListT arcs;
+        typename Csp<VarPtr>::ReviserListT revisers;
         while (cBegin != cEnd) {
-            auto[normal, reverse] = cBegin->getArcs();
-            arcs.emplace_back(std::move(normal));
-            arcs.emplace_back(std::move(reverse));
+            implementations::CspFactory::addConstraint(*cBegin, arcs, revisers);
             ++cBegin;
         }
 
-        return make_csp(vBegin, vEnd, std::begin(arcs), std::end(arcs));
-
+        return implementations::CspFactory::build<VarPtr>(std::move(vars), std::move(arcs), std::move(revisers), {},
+                                                          mode, true);
     }
 
     /**
@@ -163,29 +645,66 @@ namespace csp {
      * @param vEnd end of range of variables (exclusive)
      * @param aBegin start of range of arcs
      * @param aEnd start of range of arcs (exclusive)
+     * @param mode Representation of the constraints. csp::ConstraintMode::Matrix evaluates each arc for all value
+     * pairs once and stores the result in a csp::SupportMatrix
      * @return csp::Csp representing the problem induced by the given variables and arcs
+     * @throws std::invalid_argument if an arc refers to a variable that is not in the range of variables or if
+     * mode is csp::ConstraintMode::Matrix and the variables do not have integral values
      * @note When using csp::Arcs to specify the constraints, make sure that if you have a constraint e.g. A < B,
      * you specify both csp::Arcs representing A < B and B > A! Otherwise the problem is malformed and may lead to
      * invalid solutions!
      */
     template<typename VarIt, typename ArcIt, std::enable_if_t<type_traits::is_arc<
             std::remove_reference_t<decltype(*std::declval<ArcIt>())>>::value, int> = 0>
-    auto make_csp(VarIt vBegin, VarIt vEnd, ArcIt aBegin, ArcIt aEnd)
+    auto make_csp(VarIt vBegin, VarIt vEnd, ArcIt aBegin, ArcIt aEnd, ConstraintMode mode = ConstraintMode::Predicate)
         -> Csp<std::decay_t<decltype(*++aBegin, aBegin == aEnd, ++vBegin, vBegin == vEnd, *vBegin)>> {
         using VarPtr = std::decay_t<decltype(*vBegin)>;
-        using VarListT = typename Csp<VarPtr>::VarListT;
-        using ArcListT = typename Csp<VarPtr>::ArcListT;
-        using NeighbourListT = typename Csp<VarPtr>::NeighbourListT;
-        VarListT vars;
-        ArcListT cspArcs;
-        NeighbourListT neighbours;
-        std::copy(vBegin, vEnd, std::back_inserter(vars));
-        std::copy(aBegin, aEnd, std::back_inserter(cspArcs));
-        for (const auto &arc : cspArcs) {
-            neighbours[arc.to()].emplace_back(arc);
+        typename Csp<VarPtr>::VarListT vars(vBegin, vEnd);
+        typename Csp<VarPtr>::ArcListT arcs;
+        typename Csp<VarPtr>::ReviserListT revisers;
+        while (aBegin != aEnd) {
+            implementations::CspFactory::addArc(*aBegin, arcs, revisers);
+            ++aBegin;
         }
 
-        return Csp<VarPtr>(std::move(vars), std::move(cspArcs), std::move(neighbours));
+        return implementations::CspFactory::build<VarPtr>(std::move(vars), std::move(arcs), std::move(revisers), {},
+                                                          mode, false);
+    }
+
+    /**
+     * Creates an independent copy of a CSP, e.g. to solve the same problem concurrently. The copy refers to copies of
+     * the variables and has its own copies of all arcs and global constraints. The index structures, revision
+     * functions and compiled constraints are immutable and shared with problem without copying
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam CopyVar Type of the variable copy function. Is called with const VarPtr & and returns VarPtr
+     * @param problem CSP to be copied
+     * @param copyVar returns an independent copy of the given variable. The caller is responsible for the storage of
+     * the copies, e.g. if VarPtr is a raw pointer
+     * @return csp::Csp over the copied variables. Variable i of the copy corresponds to variable i of problem
+     * @throws std::invalid_argument if a global constraint does not support copying (see
+     * csp::type_traits::is_cloneable_global_constraint)
+     * @note Predicates of the constraints are used by both csp::Csp instances. They must not refer to the variables of
+     * problem
+     */
+    template<typename VarPtr, typename CopyVar>
+    auto clone(const Csp<VarPtr> &problem, CopyVar &&copyVar) -> Csp<VarPtr> {
+        static_assert(std::is_invocable_r_v<VarPtr, CopyVar, const VarPtr &>,
+                      "Invalid copy function! Must map from const VarPtr & -> VarPtr");
+        return implementations::CspFactory::clone(problem, std::forward<CopyVar>(copyVar));
+    }
+
+    /**
+     * Creates an independent copy of a CSP whose variables are held by std::shared_ptr. Each variable is copy
+     * constructed into a new std::shared_ptr (see csp::clone)
+     * @tparam VarT Type of the variables
+     * @param problem CSP to be copied
+     * @return csp::Csp over the copied variables. Variable i of the copy corresponds to variable i of problem
+     * @note The variables are copied as VarT. If the pointers refer to types derived from VarT, use the overload with
+     * a custom copy function
+     */
+    template<typename VarT>
+    auto clone(const Csp<std::shared_ptr<VarT>> &problem) -> Csp<std::shared_ptr<VarT>> {
+        return clone(problem, [](const std::shared_ptr<VarT> &var) { return std::make_shared<VarT>(*var); });
     }
 }
 
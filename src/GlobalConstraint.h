@@ -0,0 +1,168 @@
+/**
+ * @file GlobalConstraint.h
+ * @author Tim Luchterhand
+ * @date 18.10.26
+ * @brief This file contains the csp::GlobalConstraint class which stores constraints over an arbitrary number of
+ * variables in a csp::Csp. Global constraints share the propagation queue with the arcs of the problem and are
+ * filtered by their own propagation algorithm (e.g. csp::AllDifferent).
+ */
+
+#ifndef CSP_SOLVER_GLOBALCONSTRAINT_H
+#define CSP_SOLVER_GLOBALCONSTRAINT_H
+
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Trail.h"
+
+namespace csp {
+
+    namespace type_traits {
+        namespace implementations {
+            template<typename T>
+            auto globalConstraintTest(int) -> decltype(std::declval<const T &>().variables(),
+                    std::declval<T &>().filter(std::declval<util::NoTrail &>(),
+                                               std::declval<std::vector<std::size_t> &>()), std::true_type());
+
+            template<typename T>
+            std::false_type globalConstraintTest(...);
+
+            template<typename T>
+            auto cloneableTest(int) -> decltype(std::declval<T &>().replaceVariables(
+                    std::declval<const std::remove_reference_t<decltype(std::declval<const T &>().variables())> &>()),
+                    std::true_type());
+
+            template<typename T>
+            std::false_type cloneableTest(...);
+        }
+
+        /**
+         * Used to check if a type can be used as global constraint. Global constraints provide variables(), which
+         * returns the variables of the constraint, and filter(trail, changed), which removes inconsistent values from
+         * the value domains. filter() saves each variable to the trail before its domain is modified, appends the
+         * position of each modified variable in variables() to changed and returns false if the constraint cannot be
+         * satisfied anymore. filter() must reach a fixpoint, i.e. calling it again directly afterwards must not
+         * remove any values
+         * @tparam T Type to be checked
+         */
+        template<typename T>
+        struct is_global_constraint : decltype(implementations::globalConstraintTest<T>(0)) {};
+
+        /**
+         * Used to check if a global constraint can be copied into a cloned csp::Csp (see csp::clone). Cloneable
+         * constraints are copy constructible and provide replaceVariables(variables), which replaces the variables of
+         * the constraint by the given ones in the same order
+         * @tparam T Type to be checked
+         */
+        template<typename T>
+        struct is_cloneable_global_constraint : std::conjunction<is_global_constraint<T>,
+                std::is_copy_constructible<T>, decltype(implementations::cloneableTest<T>(0))> {};
+    }
+
+    /**
+     * Type-erased global constraint stored in a csp::Csp. Holds the concrete constraint and a pointer to its filter
+     * function instantiated for csp::util::Trail and csp::util::NoTrail
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     */
+    template<typename VarPtr>
+    class GlobalConstraint {
+    public:
+        using VarListT = std::vector<VarPtr>;
+        using FilterFn = bool (*)(void *, util::Trail<VarPtr> *, std::vector<std::size_t> &);
+        using CloneFn = std::shared_ptr<void> (*)(const void *, const VarListT &);
+
+        /**
+         * Ctor
+         * @tparam Constraint Type of the constraint (see csp::type_traits::is_global_constraint)
+         * @param constraint the concrete constraint
+         */
+        template<typename Constraint, std::enable_if_t<
+                type_traits::is_global_constraint<Constraint>::value, int> = 0>
+        explicit GlobalConstraint(Constraint constraint) : scope(constraint.variables().begin(),
+                                                                 constraint.variables().end()),
+                                                           filterFn(&filterTyped<Constraint>),
+                                                           cloneFn(cloneFunction<Constraint>()),
+                                                           constraint(std::make_shared<Constraint>(
+                                                                   std::move(constraint))) {}
+
+        /**
+         * Gets the variables of the constraint
+         * @return all variables of the constraint
+         */
+        [[nodiscard]] auto variables() const noexcept -> const VarListT & {
+            return scope;
+        }
+
+        /**
+         * Removes inconsistent values from the domains of the variables
+         * @param trail undo log, may be nullptr
+         * @param changed the positions in variables() of all modified variables are appended
+         * @return false if the constraint cannot be satisfied anymore, true otherwise
+         * @note the constraint may keep internal buffers. Hence, a constraint must not be filtered concurrently
+         */
+        bool operator()(util::Trail<VarPtr> *trail, std::vector<std::size_t> &changed) const {
+            return filterFn(constraint.get(), trail, changed);
+        }
+
+        /**
+         * Whether the constraint can be copied using clone()
+         * @return true if the concrete constraint is cloneable (see csp::type_traits::is_cloneable_global_constraint)
+         */
+        [[nodiscard]] bool cloneable() const noexcept {
+            return cloneFn != nullptr;
+        }
+
+        /**
+         * Creates an independent copy of the constraint including its internal state
+         * @param variables variables of the copy in order of variables()
+         * @return the copied constraint over the given variables
+         * @throws std::invalid_argument if the concrete constraint is not cloneable (see
+         * csp::type_traits::is_cloneable_global_constraint)
+         */
+        [[nodiscard]] GlobalConstraint clone(VarListT variables) const {
+            if (cloneFn == nullptr) {
+                throw std::invalid_argument("Global constraint cannot be cloned");
+            }
+
+            auto copy = cloneFn(constraint.get(), variables);
+            return GlobalConstraint(std::move(variables), filterFn, cloneFn, std::move(copy));
+        }
+
+    private:
+        GlobalConstraint(VarListT scope, FilterFn filterFn, CloneFn cloneFn, std::shared_ptr<void> constraint) :
+                scope(std::move(scope)), filterFn(filterFn), cloneFn(cloneFn), constraint(std::move(constraint)) {}
+
+        template<typename Constraint>
+        static constexpr auto cloneFunction() -> CloneFn {
+            if constexpr (type_traits::is_cloneable_global_constraint<Constraint>::value) {
+                return [](const void *constraint, const VarListT &variables) -> std::shared_ptr<void> {
+                    auto copy = std::make_shared<Constraint>(*static_cast<const Constraint *>(constraint));
+                    copy->replaceVariables(variables);
+                    return copy;
+                };
+            } else {
+                return nullptr;
+            }
+        }
+
+        template<typename Constraint>
+        static bool filterTyped(void *constraint, util::Trail<VarPtr> *trail, std::vector<std::size_t> &changed) {
+            auto &c = *static_cast<Constraint *>(constraint);
+            if (trail != nullptr) {
+                return c.filter(*trail, changed);
+            }
+
+            util::NoTrail noTrail;
+            return c.filter(noTrail, changed);
+        }
+
+        VarListT scope;
+        FilterFn filterFn;
+        CloneFn cloneFn;
+        std::shared_ptr<void> constraint;
+    };
+}
+
+#endif //CSP_SOLVER_GLOBALCONSTRAINT_H
@@ -0,0 +1,184 @@
+/**
+ * @file Model.h
+ * @author Tim Luchterhand
+ * @date 18.10.26
+ * @brief This file contains the csp::Model class, which separates the structure of a CSP from the value domains
+ * modified during search. The model is built once and never modified. Each csp::DomainStore created from the model owns
+ * copies of the variables, arcs and global constraints and shares the revision functions, index structures and compiled
+ * constraints of the model (see csp::clone). A store can solve any number of queries, i.e. initial assignments of some
+ * variables, without rebuilding the CSP. Stores of the same model are independent and can be used concurrently.
+ */
+
+#ifndef CSP_SOLVER_MODEL_H
+#define CSP_SOLVER_MODEL_H
+
+#include <vector>
+#include <span>
+#include <memory>
+#include <utility>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+
+#include "csp_solver.h"
+
+namespace csp {
+
+    /**
+     * Per-solve state of a csp::Model: the value domains of the variables and the internal state of the global
+     * constraints. Create using Model::store(). A store must only be used by one thread at a time
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     */
+    template<typename VarPtr>
+    class DomainStore {
+    public:
+        using VarT = typename Csp<VarPtr>::VarT;
+        using ValueT = typename VarT::ValueT;
+        /// variable index and the value it is assigned to
+        using AssumptionT = std::pair<std::size_t, ValueT>;
+
+        /**
+         * Restores the initial value domains of the model
+         */
+        void reset() {
+            util::restoreCspFromCheckpoint(copy, *initial);
+        }
+
+        /**
+         * Solves the model under the given assumptions, starting from the initial value domains (see csp::trySolve).
+         * If a solution is found, the value domains of the store are reduced to this solution
+         * @tparam Strategy Type of value selection strategy during search
+         * @tparam ValueOrder Type of the value order (see csp::type_traits::is_value_order)
+         * @param assumptions variables that are assigned before the search
+         * @param strategy variable selection strategy
+         * @param valueOrder value order
+         * @param options configuration of the solving algorithm
+         * @return whether the query was solved, is unsatisfiable or the search was aborted
+         * @throws std::out_of_range if an assumption refers to a variable that is not part of the model
+         */
+        template<typename Strategy = strategies::Mrv<VarPtr>, typename ValueOrder = strategies::DomainOrder>
+        SolveResult solve(std::span<const AssumptionT> assumptions = {}, const Strategy &strategy = Strategy(),
+                          const ValueOrder &valueOrder = ValueOrder(), const SolverOptions &options = {}) {
+            util::NoStats stats;
+            return solveImpl(assumptions, strategy, valueOrder, options, stats);
+        }
+
+        /**
+         * Solves the model under the given assumptions and collects statistics about the search (see solve())
+         * @tparam Strategy Type of value selection strategy during search
+         * @tparam ValueOrder Type of the value order (see csp::type_traits::is_value_order)
+         * @param assumptions variables that are assigned before the search
+         * @param strategy variable selection strategy
+         * @param valueOrder value order
+         * @param options configuration of the solving algorithm
+         * @param stats statistics of the search are added to stats
+         * @return whether the query was solved, is unsatisfiable or the search was aborted
+         * @throws std::out_of_range if an assumption refers to a variable that is not part of the model
+         */
+        template<typename Strategy, typename ValueOrder>
+        SolveResult solve(std::span<const AssumptionT> assumptions, const Strategy &strategy,
+                          const ValueOrder &valueOrder, const SolverOptions &options, SolveStats &stats) {
+            return solveImpl(assumptions, strategy, valueOrder, options, stats);
+        }
+
+        /**
+         * CSP over the variables of this store, e.g. to read the solution of the last query
+         * @return csp::Csp whose variable i corresponds to variable i of the model
+         */
+        [[nodiscard]] auto problem() noexcept -> Csp<VarPtr> & {
+            return copy;
+        }
+
+        [[nodiscard]] auto problem() const noexcept -> const Csp<VarPtr> & {
+            return copy;
+        }
+
+    private:
+        template<typename>
+        friend class Model;
+
+        DomainStore(Csp<VarPtr> copy, std::shared_ptr<const util::CspCheckpoint<VarT>> initial) :
+                copy(std::move(copy)), initial(std::move(initial)) {}
+
+        template<typename Strategy, typename ValueOrder, typename StatsT>
+        SolveResult solveImpl(std::span<const AssumptionT> assumptions, const Strategy &strategy,
+                              const ValueOrder &valueOrder, const SolverOptions &options, StatsT &stats) {
+            reset();
+            for (const auto &[varId, value] : assumptions) {
+                const auto &var = copy.variables.at(varId);
+                if (!util::contains(var->valueDomain(), value)) {
+                    return SolveResult::Unsatisfiable;
+                }
+
+                var->assign(value);
+            }
+
+            return util::solveImpl(copy, strategy, valueOrder, options, stats, util::StopAtFirst());
+        }
+
+        Csp<VarPtr> copy;
+        std::shared_ptr<const util::CspCheckpoint<VarT>> initial;
+    };
+
+    /**
+     * Immutable constraint model that can be solved many times and from several threads at once. The variables,
+     * arcs, compiled constraints and index structures are built once by csp::make_csp. Each query is solved on a
+     * csp::DomainStore, which only copies the variables, arcs and global constraints
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     */
+    template<typename VarPtr>
+    class Model {
+    public:
+        using VarT = typename Csp<VarPtr>::VarT;
+        using CopyFn = std::function<VarPtr(const VarPtr &)>;
+
+        /**
+         * Ctor. The current value domains of the variables are the initial domains of each query
+         * @param problem CSP to take ownership of. Must not be modified afterwards
+         * @param copyVar returns an independent copy of the given variable (see csp::clone)
+         * @throws std::invalid_argument if a global constraint of the problem does not support copying (see
+         * csp::type_traits::is_cloneable_global_constraint)
+         */
+        Model(Csp<VarPtr> problem, CopyFn copyVar) : problem(std::move(problem)), copyVar(std::move(copyVar)),
+                initial(std::make_shared<const util::CspCheckpoint<VarT>>(util::makeCspCheckpoint(this->problem))) {
+            for (const auto &global : this->problem.globalConstraints) {
+                if (!global.cloneable()) {
+                    throw std::invalid_argument("Global constraint cannot be cloned");
+                }
+            }
+        }
+
+        /**
+         * Ctor for variables held by std::shared_ptr. Each store copy constructs the variables
+         * @param problem CSP to take ownership of. Must not be modified afterwards
+         * @throws std::invalid_argument if a global constraint of the problem does not support copying
+         */
+        template<typename P = VarPtr, std::enable_if_t<std::is_same_v<P, std::shared_ptr<VarT>>, int> = 0>
+        explicit Model(Csp<VarPtr> problem) : Model(std::move(problem), [](const VarPtr &var) {
+            return std::make_shared<VarT>(*var);
+        }) {}
+
+        /**
+         * Creates a new domain store. Thread safe
+         * @return store initialized with the initial value domains of the model
+         */
+        [[nodiscard]] auto store() const -> DomainStore<VarPtr> {
+            return DomainStore<VarPtr>(clone(problem, copyVar), initial);
+        }
+
+        /**
+         * Structure of the model
+         * @return csp::Csp over the variables of the model, which hold the initial value domains
+         */
+        [[nodiscard]] auto csp() const noexcept -> const Csp<VarPtr> & {
+            return problem;
+        }
+
+    private:
+        Csp<VarPtr> problem;
+        CopyFn copyVar;
+        std::shared_ptr<const util::CspCheckpoint<VarT>> initial;
+    };
+}
+
+#endif //CSP_SOLVER_MODEL_H
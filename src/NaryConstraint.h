@@ -0,0 +1,330 @@
+/**
+ * @file NaryConstraint.h
+ * @author Tim Luchterhand
+ * @date 18.10.26
+ * @brief This file contains constraints over an arbitrary number of variables. csp::NaryConstraint is defined by a
+ * predicate over value tuples and is filtered to generalized arc consistency (GAC). csp::CallbackConstraint uses a
+ * custom propagation function instead, e.g. bounds reasoning for sum or capacity constraints. Both can be added to a
+ * csp::ConstraintSet and share the propagation queue with the binary constraints.
+ */
+
+#ifndef CSP_SOLVER_NARYCONSTRAINT_H
+#define CSP_SOLVER_NARYCONSTRAINT_H
+
+#include <vector>
+#include <span>
+#include <iterator>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+#include "Variable.h"
+#include "util.h"
+
+namespace csp {
+
+    /**
+     * Constraint over an arbitrary number of variables defined by a predicate. The predicate is called with one value
+     * for each variable (in order of variables()) and returns true if the combination is allowed. Filtering removes
+     * every value that is not part of an allowed tuple (generalized arc consistency). The last support found for each
+     * value is remembered and only searched again if it became invalid
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable. Values must be ordered by operator<
+     * @tparam Predicate Type of the predicate. Must be callable with std::span<const ValueT>
+     * @note Searching a support enumerates all combinations of the other variables' values. Use
+     * csp::CallbackConstraint for constraints over many variables with large domains
+     */
+    template<typename VarPtr, typename Predicate>
+    class NaryConstraint {
+    public:
+        using VarT = std::remove_reference_t<decltype(*std::declval<VarPtr>())>;
+        using ValueT = typename VarT::ValueT;
+        using DomainT = typename VarT::DomainT;
+        using VarListT = std::vector<VarPtr>;
+        static_assert(std::is_invocable_r_v<bool, const Predicate &, std::span<const ValueT>>,
+                      "Predicate must map from std::span<const ValueT> -> bool");
+
+        /**
+         * Ctor
+         * @param variables variables of the constraint
+         * @param predicate allowed tuples of values
+         */
+        NaryConstraint(VarListT variables, Predicate predicate) : vars(std::move(variables)),
+                                                                  predicate(std::move(predicate)),
+                                                                  values(vars.size()), residues(vars.size()),
+                                                                  hasResidue(vars.size()) {}
+
+        [[nodiscard]] auto variables() const noexcept -> const VarListT & {
+            return vars;
+        }
+
+        /**
+         * Replaces the variables of the constraint, e.g. by their copies in a cloned csp::Csp (see csp::clone)
+         * @param variables new variables in order of variables()
+         */
+        void replaceVariables(const VarListT &variables) {
+            vars = variables;
+        }
+
+        /**
+         * Checks if the constraint is satisfied by the given values
+         * @param values one value for each variable in order of variables()
+         * @return result of the predicate
+         */
+        [[nodiscard]] bool satisfied(std::span<const ValueT> values) const {
+            return predicate(values);
+        }
+
+        /**
+         * Removes all values without support until a fixpoint is reached
+         * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+         * @param trail variables are saved to the trail before their domain is modified
+         * @param changed the position of each modified variable is appended
+         * @return false if a value domain became empty
+         */
+        template<typename TrailT>
+        bool filter(TrailT &trail, std::vector<std::size_t> &changed) {
+            modified.assign(vars.size(), false);
+            bool removed = true;
+            while (removed) {
+                removed = false;
+                for (std::size_t var = 0; var < vars.size(); ++var) {
+                    auto &domain = vars[var]->valueDomain();
+                    for (auto it = domain.begin(); it != domain.end();) {
+                        if (hasSupport(var, *it)) {
+                            ++it;
+                            continue;
+                        }
+
+                        if (!modified[var]) {
+                            trail.save(vars[var]);
+                            modified[var] = true;
+                        }
+
+                        it = domain.erase(it);
+                        removed = true;
+                    }
+
+                    if (domain.empty()) {
+                        return false;
+                    }
+                }
+            }
+
+            for (std::size_t var = 0; var < vars.size(); ++var) {
+                if (modified[var]) {
+                    changed.emplace_back(var);
+                }
+            }
+
+            return true;
+        }
+
+    private:
+        static constexpr std::size_t None = std::numeric_limits<std::size_t>::max();
+
+        [[nodiscard]] std::size_t valueIndex(std::size_t var, const ValueT &val) const {
+            const auto &vals = values[var];
+            auto it = std::lower_bound(vals.begin(), vals.end(), val);
+            if (it == vals.end() || val < *it) {
+                return None;
+            }
+
+            return static_cast<std::size_t>(it - vals.begin());
+        }
+
+        /*
+         * Indexes the current domain of a variable. Only needed the first time a variable is filtered or if values
+         * were added to its domain, e.g. by setValueDomain. Forgets the residues of the variable
+         */
+        void indexValues(std::size_t var) {
+            const DomainT &domain = vars[var]->valueDomain();
+            values[var].assign(std::begin(domain), std::end(domain));
+            std::sort(values[var].begin(), values[var].end());
+            values[var].erase(std::unique(values[var].begin(), values[var].end()), values[var].end());
+            residues[var].assign(values[var].size() * vars.size(), ValueT{});
+            hasResidue[var].assign(values[var].size(), false);
+        }
+
+        bool hasSupport(std::size_t var, const ValueT &value) {
+            std::size_t val = valueIndex(var, value);
+            if (val == None) {
+                indexValues(var);
+                val = valueIndex(var, value);
+            }
+
+            auto residue = residues[var].begin() + static_cast<std::ptrdiff_t>(val * vars.size());
+            if (hasResidue[var][val] && valid(std::span<const ValueT>(residue, vars.size()))) {
+                return true;
+            }
+
+            iterators.resize(vars.size());
+            tuple.resize(vars.size());
+            tuple[var] = value;
+            for (std::size_t other = 0; other < vars.size(); ++other) {
+                if (other != var) {
+                    const DomainT &domain = vars[other]->valueDomain();
+                    if (std::empty(domain)) {
+                        return false;
+                    }
+
+                    iterators[other] = std::begin(domain);
+                    tuple[other] = *iterators[other];
+                }
+            }
+
+            while (true) {
+                if (predicate(std::span<const ValueT>(tuple))) {
+                    std::copy(tuple.begin(), tuple.end(), residue);
+                    hasResidue[var][val] = true;
+                    return true;
+                }
+
+                // advance to the next combination of the other variables' values
+                std::size_t pos = 0;
+                for (; pos < vars.size(); ++pos) {
+                    if (pos == var) {
+                        continue;
+                    }
+
+                    const DomainT &domain = vars[pos]->valueDomain();
+                    if (++iterators[pos] != std::end(domain)) {
+                        tuple[pos] = *iterators[pos];
+                        break;
+                    }
+
+                    iterators[pos] = std::begin(domain);
+                    tuple[pos] = *iterators[pos];
+                }
+
+                if (pos == vars.size()) {
+                    return false;
+                }
+            }
+        }
+
+        [[nodiscard]] bool valid(std::span<const ValueT> support) const {
+            for (std::size_t var = 0; var < vars.size(); ++var) {
+                if (!util::contains(vars[var]->valueDomain(), support[var])) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        VarListT vars;
+        Predicate predicate;
+        /// sorted values of each variable, used to index the residues
+        std::vector<std::vector<ValueT>> values;
+        /// last found support of each value of each variable. The support of values[var][i] is stored in
+        /// residues[var] at positions [i * k, (i + 1) * k) where k is the number of variables
+        std::vector<std::vector<ValueT>> residues;
+        std::vector<std::vector<bool>> hasResidue;
+        // buffers reused between calls of filter
+        std::vector<bool> modified;
+        std::vector<ValueT> tuple;
+        std::vector<typename DomainT::const_iterator> iterators;
+    };
+
+    template<typename VarPtr, typename Predicate>
+    NaryConstraint(std::vector<VarPtr>, Predicate) -> NaryConstraint<VarPtr, Predicate>;
+
+    /**
+     * Constraint over an arbitrary number of variables with a custom propagation function. The callback is called as
+     * callback(variables(), remove) where remove(position, value) removes a value from the domain of the variable at
+     * the given position in variables(). remove returns true if the value was contained in the domain. The callback
+     * returns false if the constraint cannot be satisfied anymore. It is called repeatedly until it does not remove
+     * any values. Saving the domains to the trail and reporting the modified variables is handled by the constraint
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam Callback Type of the propagation function
+     * @note remove must not be called while iterating over the value domain of the respective variable
+     */
+    template<typename VarPtr, typename Callback>
+    class CallbackConstraint {
+    public:
+        using VarT = std::remove_reference_t<decltype(*std::declval<VarPtr>())>;
+        using ValueT = typename VarT::ValueT;
+        using VarListT = std::vector<VarPtr>;
+
+        /**
+         * Ctor
+         * @param variables variables of the constraint
+         * @param callback propagation function
+         */
+        CallbackConstraint(VarListT variables, Callback callback) : vars(std::move(variables)),
+                                                                     callback(std::move(callback)) {}
+
+        [[nodiscard]] auto variables() const noexcept -> const VarListT & {
+            return vars;
+        }
+
+        /**
+         * Replaces the variables of the constraint, e.g. by their copies in a cloned csp::Csp (see csp::clone)
+         * @param variables new variables in order of variables()
+         */
+        void replaceVariables(const VarListT &variables) {
+            vars = variables;
+        }
+
+        /**
+         * Calls the propagation function until a fixpoint is reached
+         * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+         * @param trail variables are saved to the trail before their domain is modified
+         * @param changed the position of each modified variable is appended
+         * @return false if the propagation function failed or a value domain became empty
+         */
+        template<typename TrailT>
+        bool filter(TrailT &trail, std::vector<std::size_t> &changed) {
+            modified.assign(vars.size(), false);
+            bool removed = true;
+            auto remove = [this, &trail, &removed](std::size_t pos, const ValueT &val) {
+                auto &domain = vars[pos]->valueDomain();
+                for (auto it = domain.begin(); it != domain.end(); ++it) {
+                    if (*it == val) {
+                        if (!modified[pos]) {
+                            trail.save(vars[pos]);
+                            modified[pos] = true;
+                        }
+
+                        domain.erase(it);
+                        removed = true;
+                        return true;
+                    }
+                }
+
+                return false;
+            };
+
+            while (removed) {
+                removed = false;
+                if (!callback(static_cast<const VarListT &>(vars), remove)) {
+                    return false;
+                }
+
+                for (std::size_t pos = 0; pos < vars.size(); ++pos) {
+                    if (modified[pos] && vars[pos]->valueDomain().empty()) {
+                        return false;
+                    }
+                }
+            }
+
+            for (std::size_t pos = 0; pos < vars.size(); ++pos) {
+                if (modified[pos]) {
+                    changed.emplace_back(pos);
+                }
+            }
+
+            return true;
+        }
+
+    private:
+        VarListT vars;
+        Callback callback;
+        std::vector<bool> modified;
+    };
+
+    template<typename VarPtr, typename Callback>
+    CallbackConstraint(std::vector<VarPtr>, Callback) -> CallbackConstraint<VarPtr, Callback>;
+}
+
+#endif //CSP_SOLVER_NARYCONSTRAINT_H
@@ -0,0 +1,454 @@
+/**
+ * @file ParallelSearch.h
+ * @author Tim Luchterhand
+ * @date 18.10.26
+ * @brief This file contains csp::solveParallel, a parallel backtracking search with work stealing. Each worker
+ * searches its own copy of the problem (see csp::clone). When another worker is idle, a worker hands the untried
+ * values of its current choice point, together with a snapshot of the value domains, to its task queue. Idle workers
+ * steal the oldest tasks from the queues of the other workers, which tend to be the largest subtrees.
+ */
+
+#ifndef CSP_SOLVER_PARALLELSEARCH_H
+#define CSP_SOLVER_PARALLELSEARCH_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <exception>
+#include <limits>
+
+#include "csp_solver.h"
+
+namespace csp {
+    namespace util {
+
+        /**
+         * State shared by the workers of csp::solveParallel: the task queues and the termination detection
+         * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+         */
+        template<typename VarPtr>
+        class WorkStealing {
+        public:
+            using VarT = typename Csp<VarPtr>::VarT;
+            using ValueT = typename VarT::ValueT;
+            using CheckpointT = CspCheckpoint<VarT>;
+            static constexpr std::size_t Root = std::numeric_limits<std::size_t>::max();
+
+            /**
+             * Subproblem given by the value domains of an open choice point and the value to try
+             */
+            struct Task {
+                std::shared_ptr<const CheckpointT> domains;
+                /// variable that is assigned to value. Root if the task is the whole problem
+                std::size_t varId;
+                ValueT value;
+            };
+
+            /**
+             * Ctor
+             * @param numWorkers number of workers
+             * @param root value domains of the problem after the initial propagation. Is the first task of worker 0
+             */
+            WorkStealing(std::size_t numWorkers, CheckpointT root) : queues(numWorkers), idle(numWorkers - 1) {
+                queues.front().tasks.emplace_back(Task{std::make_shared<const CheckpointT>(std::move(root)), Root,
+                                                       ValueT{}});
+                queues.front().size = 1;
+                pending = 1;
+            }
+
+            /**
+             * Whether the given worker should hand open choice points to other workers
+             * @param worker index of the worker
+             * @return true if a worker is idle and the queue of the given worker is empty
+             */
+            [[nodiscard]] bool wantsWork(std::size_t worker) const noexcept {
+                return idle.load(std::memory_order_relaxed) > 0 &&
+                       queues[worker].size.load(std::memory_order_relaxed) == 0;
+            }
+
+            /**
+             * Adds one task for each of the given values to the queue of the given worker
+             * @tparam ValueIt Iterator type of the values
+             * @param worker index of the worker
+             * @param problem problem of the worker at the open choice point
+             * @param varId variable of the choice point
+             * @param begin start of range of the untried values
+             * @param end end of range of the untried values (exclusive)
+             */
+            template<typename ValueIt>
+            void publish(std::size_t worker, const Csp<VarPtr> &problem, std::size_t varId, ValueIt begin,
+                         ValueIt end) {
+                auto domains = std::make_shared<const CheckpointT>(makeCspCheckpoint(problem));
+                auto &queue = queues[worker];
+                {
+                    std::lock_guard lock(queue.mutex);
+                    for (; begin != end; ++begin) {
+                        // counted before the task becomes visible, so that pending never drops to 0 too early
+                        pending.fetch_add(1);
+                        queue.tasks.emplace_back(Task{domains, varId, *begin});
+                    }
+
+                    queue.size = queue.tasks.size();
+                }
+
+                wakeAll();
+            }
+
+            /**
+             * Takes the newest task of the worker's own queue or steals the oldest task of another worker
+             * @param worker index of the worker
+             * @return task, std::nullopt if all queues are empty
+             */
+            std::optional<Task> take(std::size_t worker) {
+                if (auto task = popBack(queues[worker])) {
+                    return task;
+                }
+
+                for (std::size_t i = 1; i < queues.size(); ++i) {
+                    if (auto task = popFront(queues[(worker + i) % queues.size()])) {
+                        return task;
+                    }
+                }
+
+                return std::nullopt;
+            }
+
+            /**
+             * Marks a task as done. Wakes up the waiting workers if it was the last task
+             */
+            void finish() {
+                if (pending.fetch_sub(1) == 1) {
+                    wakeAll();
+                }
+            }
+
+            /**
+             * Number of times tasks were published or the waiting workers were woken up. Read before take(), so that
+             * a task published in between is not missed by waitForWork()
+             * @return current version
+             */
+            [[nodiscard]] std::size_t version() const noexcept {
+                return versionCounter.load();
+            }
+
+            /**
+             * Blocks the calling worker until the version changes, all tasks are done or the search is stopped
+             * @param seen version read before the last call of take()
+             * @param stop cancelled when the search stops. Also polled periodically, since cancelling the token (or
+             * one of its parents) does not wake up waiting workers
+             */
+            void waitForWork(std::size_t seen, const CancellationToken &stop) {
+                std::unique_lock lock(waitMutex);
+                workAvailable.wait_for(lock, PollInterval, [this, seen, &stop]() {
+                    return versionCounter.load() != seen || done() || stop.cancelled();
+                });
+            }
+
+            /**
+             * Wakes up all workers blocked in waitForWork(), e.g. after the search was stopped
+             */
+            void wakeAll() {
+                {
+                    std::lock_guard lock(waitMutex);
+                    versionCounter.fetch_add(1);
+                }
+
+                workAvailable.notify_all();
+            }
+
+            /**
+             * Whether all tasks are done
+             * @return true if no task is queued or being processed
+             */
+            [[nodiscard]] bool done() const noexcept {
+                return pending.load() == 0;
+            }
+
+            /**
+             * Registers whether a worker is idle
+             * @param isIdle true if the worker is waiting for a task
+             */
+            void setIdle(bool isIdle) noexcept {
+                if (isIdle) {
+                    idle.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    idle.fetch_sub(1, std::memory_order_relaxed);
+                }
+            }
+
+        private:
+            static constexpr std::chrono::milliseconds PollInterval{10};
+
+            struct Queue {
+                std::mutex mutex;
+                std::deque<Task> tasks;
+                std::atomic<std::size_t> size = 0;
+            };
+
+            static std::optional<Task> popBack(Queue &queue) {
+                if (queue.size.load(std::memory_order_relaxed) == 0) {
+                    return std::nullopt;
+                }
+
+                std::lock_guard lock(queue.mutex);
+                if (queue.tasks.empty()) {
+                    return std::nullopt;
+                }
+
+                std::optional<Task> ret(std::move(queue.tasks.back()));
+                queue.tasks.pop_back();
+                queue.size = queue.tasks.size();
+                return ret;
+            }
+
+            static std::optional<Task> popFront(Queue &queue) {
+                if (queue.size.load(std::memory_order_relaxed) == 0) {
+                    return std::nullopt;
+                }
+
+                std::lock_guard lock(queue.mutex);
+                if (queue.tasks.empty()) {
+                    return std::nullopt;
+                }
+
+                std::optional<Task> ret(std::move(queue.tasks.front()));
+                queue.tasks.pop_front();
+                queue.size = queue.tasks.size();
+                return ret;
+            }
+
+            std::vector<Queue> queues;
+            std::atomic<std::size_t> idle;
+            std::atomic<std::size_t> pending;
+            std::mutex waitMutex;
+            std::condition_variable workAvailable;
+            std::atomic<std::size_t> versionCounter = 0;
+        };
+
+        /**
+         * Splitting policy of a single worker of csp::solveParallel (see csp::util::recursiveSolve)
+         * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+         */
+        template<typename VarPtr>
+        struct WorkerSplit {
+            WorkStealing<VarPtr> &shared;
+            std::size_t worker;
+
+            [[nodiscard]] bool wantsWork() const noexcept {
+                return shared.wantsWork(worker);
+            }
+
+            template<typename ValueIt>
+            void publish(const Csp<VarPtr> &problem, std::size_t varId, ValueIt begin, ValueIt end) {
+                shared.publish(worker, problem, varId, begin, end);
+            }
+        };
+    }
+
+    /**
+     * Solves a CSP using multiple threads (see csp::solve). The workers split the search tree dynamically: the untried
+     * values of a choice point are handed to idle workers. The search stops as soon as one worker finds a solution.
+     * If a solution is found, the value domains of the variables are reduced to this solution. Otherwise, they are left
+     * in the state after the initial propagation
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable. Must be a std::shared_ptr, since each worker
+     * searches a copy of the problem
+     * @tparam Strategy Type of value selection strategy during search
+     * @tparam ValueOrder Type of the value order (see csp::type_traits::is_value_order)
+     * @param problem CSP to be solved
+     * @param numThreads number of worker threads (including the calling thread)
+     * @param strategy variable selection strategy. Each worker uses its own copy
+     * @param valueOrder value order. Each worker uses its own copy
+     * @param options configuration of the solving algorithm. Backjumping and restarts are not supported and ignored.
+     * The node and propagation limits apply to each worker separately
+     * @return whether the problem was solved, is unsatisfiable or the search was aborted
+     * @throws std::invalid_argument if the problem cannot be cloned (see csp::clone)
+     * @note Exceptions thrown by a worker stop all workers and are rethrown
+     */
+    template<typename VarPtr, typename Strategy = strategies::Mrv<VarPtr>,
+            typename ValueOrder = strategies::DomainOrder>
+    SolveResult solveParallel(Csp<VarPtr> &problem, unsigned int numThreads, const Strategy &strategy = Strategy(),
+                              const ValueOrder &valueOrder = ValueOrder(), const SolverOptions &options = {}) {
+        static_assert(std::is_invocable_r_v<VarPtr, Strategy, Csp<VarPtr>>,
+                      "Invalid strategy object! Must map from csp::Csp -> VarPtr");
+        static_assert(type_traits::is_value_order<ValueOrder, Csp<VarPtr>>::value,
+                      "Invalid value order! Must be callable with (csp::Csp, varId, std::vector<ValueT> &)");
+        constexpr bool stateful = type_traits::is_stateful_strategy<Strategy, Csp<VarPtr>>::value;
+        constexpr bool conflictAware = stateful &&
+                                       type_traits::is_conflict_aware_strategy<Strategy, Csp<VarPtr>>::value;
+        numThreads = std::max(numThreads, 1u);
+        if (std::empty(problem.variables)) {
+            return SolveResult::Solved;
+        }
+
+        SolverOptions workerOptions = options;
+        auto &cancellation = workerOptions.limits.cancellation;
+        // cancelled by the first worker that finishes, without cancelling the caller's token
+        cancellation = cancellation.has_value() ? cancellation->child() : CancellationToken();
+        const CancellationToken stop = *cancellation;
+        {
+            util::Propagator<VarPtr> propagator(problem, options.propagation);
+            util::SearchLimit limit(Restarts::None, 1, 1, workerOptions.limits);
+            propagator.limitWith(&limit);
+            util::NoTrail noTrail;
+            if (!propagator.propagate(noTrail)) {
+                return limit.aborted() ? SolveResult::Aborted : SolveResult::Unsatisfiable;
+            }
+        }
+
+        std::vector<Csp<VarPtr>> copies;
+        copies.reserve(numThreads);
+        for (unsigned int i = 0; i < numThreads; ++i) {
+            copies.emplace_back(clone(problem));
+        }
+
+        util::WorkStealing<VarPtr> shared(numThreads, util::makeCspCheckpoint(problem));
+        std::atomic<std::size_t> winner = numThreads;
+        std::atomic_bool aborted = false;
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        auto worker = [&](std::size_t id) {
+            using ValueT = typename Csp<VarPtr>::VarT::ValueT;
+            auto &copy = copies[id];
+            util::Propagator<VarPtr> propagator(copy, options.propagation);
+            util::SearchLimit limit(Restarts::None, 1, 1, workerOptions.limits);
+            propagator.limitWith(&limit);
+            util::Trail<VarPtr> trail(copy);
+            util::NoStats stats;
+            util::NoBackjumping noBackjumping;
+            util::WorkerSplit<VarPtr> split{shared, id};
+            util::StopAtFirst onSolution;
+            // strategies and value orders may contain a random number generator
+            Strategy workerStrategy(strategy);
+            const ValueOrder workerOrder(valueOrder);
+            if constexpr (stateful) {
+                workerStrategy.init(copy);
+            }
+
+            // the domains of a task are restored without the trail, i.e. at depth 0. Global constraints may keep
+            // state that depends on the domains (e.g. csp::TableConstraint), so all of them are filtered again
+            const bool fullPropagation = !copy.globalConstraints.empty();
+            auto runTask = [&](const typename util::WorkStealing<VarPtr>::Task &task) {
+                util::restoreCspFromCheckpoint(copy, *task.domains);
+                const bool root = task.varId == util::WorkStealing<VarPtr>::Root;
+                if (!root) {
+                    copy.variables[task.varId]->assign(ValueT(task.value));
+                }
+
+                if (!root || fullPropagation) {
+                    const bool consistent = (root || !limit.onNode()) &&
+                                            (fullPropagation ? propagator.propagate(trail, stats) :
+                                                               propagator.propagateFrom(task.varId, trail, stats));
+                    if (!consistent) {
+                        if constexpr (conflictAware) {
+                            if (!limit.aborted()) {
+                                workerStrategy.onConflict(copy, propagator.conflictArc());
+                            }
+                        }
+
+                        return false;
+                    }
+
+                    if (limit.aborted()) {
+                        return false;
+                    }
+                }
+
+                if constexpr (stateful) {
+                    for (std::size_t var = 0; var < copy.variables.size(); ++var) {
+                        workerStrategy.onDomainChanged(copy, var);
+                    }
+                }
+
+                return util::recursiveSolve(copy, workerStrategy, workerOrder, propagator, trail, stats, onSolution,
+                                            util::NoPruning(), noBackjumping, limit, split);
+            };
+
+            bool idle = id != 0;
+            try {
+                while (!stop.cancelled() && !shared.done()) {
+                    const std::size_t version = shared.version();
+                    auto task = shared.take(id);
+                    if (!task.has_value()) {
+                        if (!idle) {
+                            shared.setIdle(true);
+                            idle = true;
+                        }
+
+                        shared.waitForWork(version, stop);
+                        continue;
+                    }
+
+                    if (idle) {
+                        shared.setIdle(false);
+                        idle = false;
+                    }
+
+                    const bool solved = runTask(*task);
+                    shared.finish();
+                    if (solved) {
+                        std::size_t expected = numThreads;
+                        if (winner.compare_exchange_strong(expected, id)) {
+                            stop.cancel();
+                        }
+
+                        break;
+                    }
+
+                    if (limit.aborted()) {
+                        aborted = true;
+                        stop.cancel();
+                        break;
+                    }
+                }
+
+                if (stop.cancelled() && winner.load() == numThreads) {
+                    aborted = true;
+                }
+            } catch (...) {
+                std::lock_guard lock(errorMutex);
+                if (error == nullptr) {
+                    error = std::current_exception();
+                }
+
+                stop.cancel();
+            }
+
+            // workers that are still waiting have to notice that the search stopped
+            shared.wakeAll();
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(numThreads - 1);
+        for (unsigned int i = 1; i < numThreads; ++i) {
+            threads.emplace_back(worker, i);
+        }
+
+        worker(0);
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        if (error != nullptr) {
+            std::rethrow_exception(error);
+        }
+
+        if (winner.load() != numThreads) {
+            const auto &solution = copies[winner.load()];
+            for (std::size_t i = 0; i < problem.variables.size(); ++i) {
+                problem.variables[i]->assign(solution.variables[i]->valueDomain().front());
+            }
+
+            return SolveResult::Solved;
+        }
+
+        return aborted ? SolveResult::Aborted : SolveResult::Unsatisfiable;
+    }
+}
+
+#endif //CSP_SOLVER_PARALLELSEARCH_H
@@ -0,0 +1,167 @@
+/**
+ * @file Portfolio.h
+ * @author Tim Luchterhand
+ * @date 18.10.26
+ * @brief This file contains the csp::Portfolio class which solves a CSP with several solver configurations at once.
+ * Each configuration runs on its own thread on an independent copy of the problem (see csp::clone). The first
+ * configuration that solves the problem or proves it unsatisfiable cancels all others.
+ */
+
+#ifndef CSP_SOLVER_PORTFOLIO_H
+#define CSP_SOLVER_PORTFOLIO_H
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+#include "csp_solver.h"
+
+namespace csp {
+
+    /**
+     * Portfolio of solver configurations (variable selection strategy, value order and csp::SolverOptions) that are
+     * run concurrently. Different problems favour different strategies. The portfolio takes as long as the fastest
+     * configuration on each problem (given enough cores)
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable. Must be a std::shared_ptr, since each thread
+     * solves a copy of the problem
+     */
+    template<typename VarPtr>
+    class Portfolio {
+    public:
+        /// index returned by winner() if no configuration finished
+        static constexpr std::size_t None = std::numeric_limits<std::size_t>::max();
+
+        /**
+         * Adds a solver configuration
+         * @tparam Strategy Type of value selection strategy during search
+         * @tparam ValueOrder Type of the value order (see csp::type_traits::is_value_order)
+         * @param strategy variable selection strategy
+         * @param valueOrder value order
+         * @param options configuration of the solving algorithm. The limits apply to this configuration only. If a
+         * cancellation token is given, it cancels this configuration
+         */
+        template<typename Strategy, typename ValueOrder = strategies::DomainOrder>
+        void add(Strategy strategy, ValueOrder valueOrder = ValueOrder(), SolverOptions options = {}) {
+            static_assert(type_traits::is_value_order<ValueOrder, Csp<VarPtr>>::value,
+                          "Invalid value order! Must be callable with (csp::Csp, varId, std::vector<ValueT> &)");
+            configurations.emplace_back(Configuration{std::move(options), [strategy = std::move(strategy),
+                    valueOrder = std::move(valueOrder)](Csp<VarPtr> &problem, const SolverOptions &options) {
+                util::NoStats stats;
+                return util::solveImpl(problem, strategy, valueOrder, options, stats, util::StopAtFirst());
+            }});
+        }
+
+        /**
+         * Number of solver configurations
+         * @return number of configurations added
+         */
+        [[nodiscard]] std::size_t size() const noexcept {
+            return configurations.size();
+        }
+
+        /**
+         * Solves the problem with all configurations concurrently and returns as soon as the first configuration
+         * solved the problem or proved that it has no solution. A configuration that reaches one of its limits does
+         * not stop the others. If a solution is found, the value domains of the variables are reduced to this
+         * solution. Otherwise, the problem is not modified
+         * @param problem CSP to be solved. Is only read while the configurations are running
+         * @return SolveResult::Aborted if all configurations reached their limits or were cancelled
+         * @throws std::invalid_argument if no configuration was added or if the problem cannot be cloned
+         * @note Exceptions thrown by a configuration cancel all others and are rethrown. Must not be called
+         * concurrently on the same portfolio
+         */
+        SolveResult solve(Csp<VarPtr> &problem) {
+            if (configurations.empty()) {
+                throw std::invalid_argument("Portfolio does not contain any solver configuration");
+            }
+
+            std::vector<Csp<VarPtr>> copies;
+            std::vector<SolverOptions> options;
+            copies.reserve(configurations.size());
+            options.reserve(configurations.size());
+            for (const auto &configuration : configurations) {
+                copies.emplace_back(clone(problem));
+                options.emplace_back(configuration.options);
+                auto &cancellation = options.back().limits.cancellation;
+                cancellation = cancellation.has_value() ? cancellation->child() : CancellationToken();
+            }
+
+            auto cancelAll = [&options]() {
+                for (const auto &option : options) {
+                    option.limits.cancellation->cancel();
+                }
+            };
+
+            std::atomic<std::size_t> first = None;
+            SolveResult result = SolveResult::Aborted;
+            std::exception_ptr error;
+            std::mutex errorMutex;
+            auto run = [&](std::size_t i) {
+                try {
+                    const SolveResult ret = configurations[i].solve(copies[i], options[i]);
+                    std::size_t expected = None;
+                    if (ret != SolveResult::Aborted && first.compare_exchange_strong(expected, i)) {
+                        result = ret;
+                        cancelAll();
+                    }
+                } catch (...) {
+                    std::lock_guard lock(errorMutex);
+                    if (error == nullptr) {
+                        error = std::current_exception();
+                    }
+
+                    cancelAll();
+                }
+            };
+
+            std::vector<std::thread> threads;
+            threads.reserve(configurations.size() - 1);
+            for (std::size_t i = 1; i < configurations.size(); ++i) {
+                threads.emplace_back(run, i);
+            }
+
+            run(0);
+            for (auto &thread : threads) {
+                thread.join();
+            }
+
+            if (error != nullptr) {
+                std::rethrow_exception(error);
+            }
+
+            lastWinner = first;
+            if (result == SolveResult::Solved) {
+                const auto &solution = copies[lastWinner];
+                for (std::size_t i = 0; i < problem.variables.size(); ++i) {
+                    problem.variables[i]->assign(solution.variables[i]->valueDomain().front());
+                }
+            }
+
+            return result;
+        }
+
+        /**
+         * Index of the configuration that finished first during the last call to solve()
+         * @return position of the configuration in order of add(), None if all configurations were aborted
+         */
+        [[nodiscard]] std::size_t winner() const noexcept {
+            return lastWinner;
+        }
+
+    private:
+        struct Configuration {
+            SolverOptions options;
+            std::function<SolveResult(Csp<VarPtr> &, const SolverOptions &)> solve;
+        };
+
+        std::vector<Configuration> configurations;
+        std::size_t lastWinner = None;
+    };
+}
+
+#endif //CSP_SOLVER_PORTFOLIO_H
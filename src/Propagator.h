@@ -0,0 +1,332 @@
+/**
+ * @file Propagator.h
+ * @author Tim Luchterhand
+ * @date 18.10.26
+ * @brief This file contains the csp::util::Propagator class which establishes arc consistency during search. The
+ * propagator owns all data that is reused between propagation calls (the arc queue and, for AC-3rm, the residual
+ * supports of each arc). The arc consistency algorithm is selected using csp::Propagation.
+ */
+
+#ifndef CSP_SOLVER_PROPAGATOR_H
+#define CSP_SOLVER_PROPAGATOR_H
+
+#include <vector>
+#include <limits>
+#include <type_traits>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#include "Csp.h"
+#include "ArcQueue.h"
+#include "Trail.h"
+#include "util.h"
+#include "SolveStats.h"
+#include "Backjumping.h"
+#include "SearchLimit.h"
+
+namespace csp {
+
+    /**
+     * Arc consistency algorithm used during search
+     */
+    enum class Propagation {
+        /// Plain AC-3. Every revision searches the whole destination domain for a support of each value
+        Ac3,
+        /// AC-3 with residual supports. The last support found for each (arc, value) pair is remembered and the
+        /// destination domain is only searched again if this support was removed. Requires integral values,
+        /// falls back to Ac3 otherwise. Benefits most from domains with fast lookup like csp::BitsetDomain.
+        /// Has no effect on problems created with csp::ConstraintMode::Matrix which always use the support matrices
+        Ac3rm
+    };
+
+    namespace util {
+
+        /**
+         * Stores the last found support of each value of the source variable for each arc (AC-3rm). Values are
+         * mapped to table indices using the range of the initial value domains. Variables whose range is much larger
+         * than their domain get no table and are revised using plain AC-3
+         * @tparam VarPtr Pointer-type to a type derived from csp::Variable with integral value type
+         */
+        template<typename VarPtr>
+        class ResidualSupports {
+        public:
+            using VarT = typename Csp<VarPtr>::VarT;
+            using ValueT = typename VarT::ValueT;
+            static_assert(std::is_integral_v<ValueT>, "Residual supports require integral values");
+
+            ResidualSupports() = default;
+
+            /**
+             * Ctor. Creates empty residue tables covering the current value domains of all variables
+             * @param problem CSP the residues are created for
+             */
+            explicit ResidualSupports(const Csp<VarPtr> &problem) {
+                offsets.reserve(problem.variables.size());
+                ranges.reserve(problem.variables.size());
+                for (const auto &var : problem.variables) {
+                    const auto &domain = var->valueDomain();
+                    if (std::empty(domain)) {
+                        offsets.emplace_back(ValueT{});
+                        ranges.emplace_back(0);
+                        continue;
+                    }
+
+                    auto [min, max] = std::minmax_element(std::begin(domain), std::end(domain));
+                    // computed in the unsigned type, so that the difference cannot overflow
+                    const std::uintmax_t span = static_cast<std::uintmax_t>(*max) - static_cast<std::uintmax_t>(*min);
+                    offsets.emplace_back(*min);
+                    const bool dense = span < MaxSparsity * std::size(domain);
+                    ranges.emplace_back(dense ? static_cast<std::size_t>(span) + 1 : 0);
+                }
+
+                residues.reserve(problem.arcs.size());
+                for (std::size_t from : problem.arcSources) {
+                    residues.emplace_back(ranges[from], NoSupport);
+                }
+            }
+
+            /**
+             * Removes all inconsistent values from the source node of the given arc. A value is only checked against
+             * the whole destination domain if its residual support is no longer contained in the destination domain
+             * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+             * @param problem The CSP containing the arc
+             * @param arcId index of the arc
+             * @param trail The source node's value domain is saved to the trail before it is modified
+             * @return True if the value domain of the source node was modified, false otherwise
+             */
+            template<typename TrailT>
+            bool removeInconsistent(const Csp<VarPtr> &problem, std::size_t arcId, TrailT &trail) {
+                const auto &arc = problem.arcs[arcId];
+                const auto &reviser = problem.arcRevisers[arcId];
+                const std::size_t fromId = problem.arcSources[arcId];
+                const std::size_t toId = problem.arcTargets[arcId];
+                auto &fromDomain = arc.from()->valueDomain();
+                const auto &toDomain = arc.to()->valueDomain();
+                auto &arcResidues = residues[arcId];
+                bool removed = false;
+                ValueT support{};
+                for (auto it = fromDomain.begin(); it != fromDomain.end();) {
+                    const ValueT valFrom = *it;
+                    const std::size_t index = tableIndex(fromId, valFrom);
+                    if (index != NoSupport && arcResidues[index] != NoSupport &&
+                        util::contains(toDomain, valueOf(toId, arcResidues[index]))) {
+                        ++it;
+                        continue;
+                    }
+
+                    const bool consistent = reviser.findSupport(arc, valFrom, support);
+                    if (consistent && index != NoSupport) {
+                        arcResidues[index] = tableIndex(toId, support);
+                    }
+
+                    if (!consistent) {
+                        if (!removed) {
+                            trail.save(fromId, arc.from());
+                        }
+
+                        it = fromDomain.erase(it);
+                        removed = true;
+                    } else {
+                        ++it;
+                    }
+                }
+
+                return removed;
+            }
+
+        private:
+            static constexpr std::size_t NoSupport = std::numeric_limits<std::size_t>::max();
+            /// maximum ratio of value range to domain size for which a residue table is created
+            static constexpr std::size_t MaxSparsity = 16;
+
+            [[nodiscard]] std::size_t tableIndex(std::size_t var, ValueT val) const noexcept {
+                // values below the offset wrap around and are outside of the range as well
+                const std::uintmax_t index = static_cast<std::uintmax_t>(val) -
+                                             static_cast<std::uintmax_t>(offsets[var]);
+                return index < ranges[var] ? static_cast<std::size_t>(index) : NoSupport;
+            }
+
+            [[nodiscard]] ValueT valueOf(std::size_t var, std::size_t index) const noexcept {
+                return static_cast<ValueT>(static_cast<std::uintmax_t>(offsets[var]) + index);
+            }
+
+            std::vector<ValueT> offsets;
+            std::vector<std::size_t> ranges;
+            std::vector<std::vector<std::size_t>> residues;
+        };
+
+        /**
+         * Establishes arc consistency during search using the selected algorithm. All buffers are allocated once
+         * on construction and reused for each propagation
+         * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+         */
+        template<typename VarPtr>
+        class Propagator {
+            using ValueT = typename Csp<VarPtr>::VarT::ValueT;
+            static constexpr bool residuesSupported = std::is_integral_v<ValueT>;
+            using ResiduesT = std::conditional_t<residuesSupported, ResidualSupports<VarPtr>, std::nullptr_t>;
+        public:
+            /**
+             * Ctor
+             * @param problem CSP to propagate. Must outlive the propagator
+             * @param algorithm Arc consistency algorithm
+             */
+            Propagator(const Csp<VarPtr> &problem, Propagation algorithm) :
+                    problem(problem), queue(problem.queueSize()),
+                    algorithm(residuesSupported ? algorithm : Propagation::Ac3), residues(makeResidues()) {
+                changed.reserve(maxScope(problem));
+            }
+
+            /**
+             * Obtains arc consistency by revising all arcs and filtering all global constraints of the problem
+             * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+             * @tparam StatsT Type of the statistics (csp::SolveStats or csp::util::NoStats)
+             * @param trail All domain modifications are recorded in the trail
+             * @param stats statistics of the propagation are added to stats
+             * @return True if arc consistency was obtained, false if not possible or if the search limit was reached
+             */
+            template<typename TrailT, typename StatsT = NoStats>
+            bool propagate(TrailT &trail, StatsT &&stats = StatsT()) {
+                queue.pushAll();
+                return run(trail, stats);
+            }
+
+            /**
+             * Restores arc consistency after the value domain of the given variable was reduced
+             * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+             * @tparam StatsT Type of the statistics (csp::SolveStats or csp::util::NoStats)
+             * @param varId index of the changed variable
+             * @param trail All domain modifications are recorded in the trail
+             * @param stats statistics of the propagation are added to stats
+             * @return True if arc consistency was obtained, false if not possible or if the search limit was reached
+             */
+            template<typename TrailT, typename StatsT = NoStats>
+            bool propagateFrom(std::size_t varId, TrailT &trail, StatsT &&stats = StatsT()) {
+                enqueueVariable(problem, queue, varId);
+                return run(trail, stats);
+            }
+
+            /**
+             * Gets the arc whose revision emptied a value domain or the global constraint that failed. Only meaningful
+             * after a propagation failed
+             * @return queue index of the conflict arc or global constraint (arcs.size() + constraint index)
+             */
+            [[nodiscard]] std::size_t conflictArc() const noexcept {
+                return lastRevised;
+            }
+
+            /**
+             * Reports the cause of each domain reduction to the given backjumping bookkeeping
+             * @param backjumping conflict analysis of the search, nullptr to disable
+             */
+            void explainWith(Backjumping<VarPtr> *backjumping) noexcept {
+                explanations = backjumping;
+            }
+
+            /**
+             * Counts each arc revision and global constraint filtering. Propagation stops as soon as the search is
+             * aborted
+             * @param searchLimit limits of the search, nullptr to disable
+             */
+            void limitWith(SearchLimit *searchLimit) noexcept {
+                limit = searchLimit;
+            }
+
+        private:
+            auto makeResidues() const -> ResiduesT {
+                if constexpr (residuesSupported) {
+                    return algorithm == Propagation::Ac3rm ? ResiduesT(problem) : ResiduesT();
+                } else {
+                    return nullptr;
+                }
+            }
+
+            template<typename TrailT, typename StatsT>
+            bool run(TrailT &trail, StatsT &stats) {
+                if constexpr (type_traits::collects_stats<StatsT>::value) {
+                    ++stats.ac3Calls;
+                    const auto start = std::chrono::steady_clock::now();
+                    const bool ret = revise(trail, stats);
+                    stats.propagationTime += std::chrono::steady_clock::now() - start;
+                    return ret && (limit == nullptr || !limit->aborted());
+                } else {
+                    return revise(trail, stats) && (limit == nullptr || !limit->aborted());
+                }
+            }
+
+            template<typename TrailT, typename StatsT>
+            bool revise(TrailT &trail, StatsT &stats) {
+                if constexpr (residuesSupported) {
+                    if (!problem.arcSupports.empty()) {
+                        return process([this, &trail](std::size_t arc) {
+                            return removeInconsistent(problem, arc, trail);
+                        }, trail, stats);
+                    }
+
+                    if (algorithm == Propagation::Ac3rm) {
+                        return process([this, &trail](std::size_t arc) {
+                            return residues.removeInconsistent(problem, arc, trail);
+                        }, trail, stats);
+                    }
+                }
+
+                return process(predicateReviser(problem, trail), trail, stats);
+            }
+
+            template<typename Revise, typename TrailT, typename StatsT>
+            bool process(Revise &&reviseArc, TrailT &trail, StatsT &stats) {
+                auto filter = globalFilter(problem, trail);
+                return processArcs(problem, queue, [this, &reviseArc, &trail](std::size_t arc) {
+                    if (limit != nullptr && limit->onPropagation()) {
+                        // ends the propagation, the abort is reported by run
+                        queue.clear();
+                        return false;
+                    }
+
+                    // if the revision wipes out the source domain, this is the conflict arc
+                    lastRevised = arc;
+                    const bool revised = reviseArc(arc);
+                    if (revised && explanations != nullptr) {
+                        explanations->explainArc(arc, trail);
+                    }
+
+                    return revised;
+                }, [this, &filter, &trail](std::size_t constraint, std::vector<std::size_t> &changed) {
+                    if (limit != nullptr && limit->onPropagation()) {
+                        return false;
+                    }
+
+                    lastRevised = problem.arcs.size() + constraint;
+                    const bool consistent = filter(constraint, changed);
+                    if (consistent && explanations != nullptr) {
+                        explanations->explainGlobal(constraint, changed, trail);
+                    }
+
+                    return consistent;
+                }, changed, stats);
+            }
+
+            static std::size_t maxScope(const Csp<VarPtr> &problem) noexcept {
+                std::size_t ret = 0;
+                for (std::size_t g = 0; g < problem.globalConstraints.size(); ++g) {
+                    ret = std::max(ret, problem.scope(g).size());
+                }
+
+                return ret;
+            }
+
+            const Csp<VarPtr> &problem;
+            ArcQueue queue;
+            /// positions of the variables modified by a global constraint
+            std::vector<std::size_t> changed;
+            Propagation algorithm;
+            ResiduesT residues;
+            std::size_t lastRevised = 0;
+            Backjumping<VarPtr> *explanations = nullptr;
+            SearchLimit *limit = nullptr;
+        };
+    }
+}
+
+#endif //CSP_SOLVER_PROPAGATOR_H
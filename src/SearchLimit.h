@@ -0,0 +1,266 @@
+/**
+ * @file SearchLimit.h
+ * @author Tim Luchterhand
+ * @date 18.10.26
+ * @brief This file contains the restart policies and the limits of the solver. A run of the search is interrupted as
+ * soon as its number of backtracks reaches the cutoff of the run. The search then starts again from the root with the
+ * next cutoff. Together with randomized strategies this avoids getting stuck in a bad part of the search space early
+ * on (heavy-tailed runtime behaviour). Independent of restarts, the whole search is aborted if a deadline, a node or
+ * propagation limit is reached or if it is cancelled from another thread.
+ */
+
+#ifndef CSP_SOLVER_SEARCHLIMIT_H
+#define CSP_SOLVER_SEARCHLIMIT_H
+
+#include <cstddef>
+#include <limits>
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <optional>
+
+namespace csp {
+
+    /**
+     * Restart policy of the search
+     */
+    enum class Restarts {
+        /// search is never restarted
+        None,
+        /// cutoffs follow the Luby sequence 1, 1, 2, 1, 1, 2, 4, 1, ... multiplied by the base cutoff
+        Luby,
+        /// cutoffs grow geometrically, starting at the base cutoff
+        Geometric
+    };
+
+    /**
+     * Cooperative cancellation of a running search. Copies share the same state, so a copy can be passed to the
+     * solver while another thread keeps the original to cancel the search
+     */
+    class CancellationToken {
+    public:
+        CancellationToken() : state(std::make_shared<State>()) {}
+
+        /**
+         * Creates a token that is cancelled together with this token but can also be cancelled on its own
+         * @return new token depending on this token
+         */
+        [[nodiscard]] CancellationToken child() const {
+            CancellationToken ret;
+            ret.state->parent = state;
+            return ret;
+        }
+
+        /**
+         * Requests all searches using this token or one of its children to stop. Thread safe
+         */
+        void cancel() const noexcept {
+            state->flag.store(true, std::memory_order_relaxed);
+        }
+
+        /**
+         * Whether cancel() was called on this token, one of its copies or one of its parents. Thread safe
+         * @return true if the search should stop
+         */
+        [[nodiscard]] bool cancelled() const noexcept {
+            for (const State *current = state.get(); current != nullptr; current = current->parent.get()) {
+                if (current->flag.load(std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    private:
+        struct State {
+            std::atomic_bool flag = false;
+            std::shared_ptr<const State> parent;
+        };
+
+        std::shared_ptr<State> state;
+    };
+
+    /**
+     * Limits of the whole search (over all restarts). If a limit is reached, the search is aborted
+     */
+    struct SearchLimits {
+        /// point in time at which the search is aborted
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+        /// maximum number of assignments
+        std::size_t nodes = std::numeric_limits<std::size_t>::max();
+        /// maximum number of arc revisions and global constraint filterings
+        std::size_t propagations = std::numeric_limits<std::size_t>::max();
+        /// the search is aborted as soon as the token is cancelled
+        std::optional<CancellationToken> cancellation;
+    };
+
+    namespace util {
+        /**
+         * Element of the Luby sequence 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, ...
+         * @param i position in the sequence starting at 1
+         * @return i-th element of the sequence
+         */
+        constexpr std::size_t luby(std::size_t i) noexcept {
+            while (true) {
+                // size = 2^k - 1 is the length of the smallest complete subsequence containing i
+                std::size_t size = 1;
+                while (size < i) {
+                    size = 2 * size + 1;
+                }
+
+                if (size == i) {
+                    return (size + 1) / 2;
+                }
+
+                // the second half of the subsequence repeats its first half
+                i -= size / 2;
+            }
+        }
+
+        /**
+         * Limits the number of backtracks of a run of the search according to the restart policy and aborts the
+         * search if one of the csp::SearchLimits is reached. The deadline and the cancellation token are only polled
+         * every PollInterval nodes or propagations
+         */
+        class SearchLimit {
+        public:
+            /**
+             * Ctor
+             * @param policy restart policy
+             * @param base cutoff of the first run
+             * @param growth factor by which the cutoff grows with each restart (only used for Restarts::Geometric)
+             * @param limits limits of the whole search
+             */
+            SearchLimit(Restarts policy, std::size_t base, double growth, SearchLimits limits = {}) : policy(policy),
+                    base(std::max<std::size_t>(base, 1)), growth(std::max(growth, 1.0)),
+                    geometric(static_cast<double>(this->base)),
+                    cutoff(policy == Restarts::None ? std::numeric_limits<std::size_t>::max() : this->base),
+                    limits(std::move(limits)) {}
+
+            /**
+             * Counts a backtrack of the current run
+             * @return true if the cutoff of the run is reached. Then the search has to return to the root
+             */
+            bool onBacktrack() noexcept {
+                interrupt = ++backtracks >= cutoff;
+                return interrupt;
+            }
+
+            /**
+             * Counts an assignment
+             * @return true if the search is aborted
+             */
+            bool onNode() noexcept {
+                return ++nodes > limits.nodes ? abort() : poll();
+            }
+
+            /**
+             * Counts an arc revision or global constraint filtering
+             * @return true if the search is aborted
+             */
+            bool onPropagation() noexcept {
+                return ++propagations > limits.propagations ? abort() : poll();
+            }
+
+            /**
+             * Whether propagation has to be counted using onPropagation(). Otherwise, onNode() suffices
+             * @return true if a propagation limit, a deadline or a cancellation token is set
+             */
+            [[nodiscard]] bool limitsPropagation() const noexcept {
+                return limits.propagations != std::numeric_limits<std::size_t>::max() ||
+                       limits.deadline != std::chrono::steady_clock::time_point::max() ||
+                       limits.cancellation.has_value();
+            }
+
+            /**
+             * Whether the search was aborted because one of the limits was reached
+             * @return true if the search has to stop
+             */
+            [[nodiscard]] bool aborted() const noexcept {
+                return stop;
+            }
+
+            /**
+             * Whether the current run was interrupted, either by the restart policy or because the search was aborted
+             * @return true if the search has to return to the root
+             */
+            [[nodiscard]] bool interrupted() const noexcept {
+                return interrupt;
+            }
+
+            /**
+             * Starts the next run if the current run was interrupted by the restart policy
+             * @return true if the search has to be restarted
+             */
+            bool restart() noexcept {
+                if (!interrupt || stop) {
+                    return false;
+                }
+
+                interrupt = false;
+                backtracks = 0;
+                ++run;
+                if (policy == Restarts::Luby) {
+                    cutoff = base * luby(run + 1);
+                } else {
+                    geometric *= growth;
+                    cutoff = geometric < static_cast<double>(std::numeric_limits<std::size_t>::max()) ?
+                             static_cast<std::size_t>(geometric) : std::numeric_limits<std::size_t>::max();
+                }
+
+                return true;
+            }
+
+            /**
+             * Number of restarts so far
+             * @return index of the current run
+             */
+            [[nodiscard]] std::size_t restarts() const noexcept {
+                return run;
+            }
+
+            /// number of nodes or propagations between two checks of the deadline and the cancellation token
+            static constexpr std::size_t PollInterval = 64;
+
+        private:
+            bool abort() noexcept {
+                stop = interrupt = true;
+                return true;
+            }
+
+            bool poll() noexcept {
+                if (--countdown != 0) {
+                    return false;
+                }
+
+                countdown = PollInterval;
+                if ((limits.cancellation.has_value() && limits.cancellation->cancelled()) ||
+                    (limits.deadline != std::chrono::steady_clock::time_point::max() &&
+                     std::chrono::steady_clock::now() >= limits.deadline)) {
+                    return abort();
+                }
+
+                return false;
+            }
+
+            Restarts policy;
+            std::size_t base;
+            double growth;
+            double geometric;
+            std::size_t cutoff;
+            std::size_t backtracks = 0;
+            std::size_t run = 0;
+            bool interrupt = false;
+            SearchLimits limits;
+            std::size_t nodes = 0;
+            std::size_t propagations = 0;
+            // the first poll checks immediately, so that a search started after the deadline stops right away
+            std::size_t countdown = 1;
+            bool stop = false;
+        };
+    }
+}
+
+#endif //CSP_SOLVER_SEARCHLIMIT_H
@@ -0,0 +1,70 @@
+/**
+ * @file SolveStats.h
+ * @author Tim Luchterhand
+ * @date 18.10.26
+ * @brief This file contains the csp::SolveStats struct which collects statistics about the search and the propagation
+ * during csp::solve. Statistics are only collected if a csp::SolveStats object is passed to the solver. Otherwise
+ * csp::util::NoStats is used and all instrumentation is removed at compile time.
+ */
+
+#ifndef CSP_SOLVER_SOLVESTATS_H
+#define CSP_SOLVER_SOLVESTATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <type_traits>
+
+namespace csp {
+
+    /**
+     * Statistics of a single or multiple calls to csp::solve. Counters are only ever increased by the solver
+     */
+    struct SolveStats {
+        /// number of assignments made during search
+        std::size_t nodes = 0;
+        /// number of assignments that were undone
+        std::size_t backtracks = 0;
+        /// number of search nodes whose remaining values were skipped by conflict-directed backjumping
+        std::size_t backjumps = 0;
+        /// number of nogoods recorded
+        std::size_t nogoods = 0;
+        /// number of solutions found
+        std::size_t solutions = 0;
+        /// number of times the search was restarted from the root
+        std::size_t restarts = 0;
+        /// maximum number of simultaneously open choice points
+        std::size_t maxDepth = 0;
+        /// number of arc revisions
+        std::size_t arcsRevised = 0;
+        /// number of times a global constraint was filtered
+        std::size_t globalsFiltered = 0;
+        /// number of values removed from value domains during propagation
+        std::size_t valuesPruned = 0;
+        /// number of arc consistency runs (initial propagation and one for each assignment)
+        std::size_t ac3Calls = 0;
+        /// approximate number of bytes of value domains copied to the trail
+        std::size_t checkpointBytes = 0;
+        /// time spent establishing arc consistency
+        std::chrono::nanoseconds propagationTime{0};
+        /// time spent in search excluding propagation (variable selection, assignment, backtracking)
+        std::chrono::nanoseconds branchingTime{0};
+    };
+
+    namespace util {
+        /**
+         * Statistics type that does not record anything. Used when no statistics are requested
+         */
+        struct NoStats {};
+    }
+
+    namespace type_traits {
+        /**
+         * Used to check whether statistics are collected into the given type
+         * @tparam T Type to be checked (csp::SolveStats or csp::util::NoStats)
+         */
+        template<typename T>
+        struct collects_stats : std::is_same<T, SolveStats> {};
+    }
+}
+
+#endif //CSP_SOLVER_SOLVESTATS_H
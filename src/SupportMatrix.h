@@ -0,0 +1,244 @@
+/**
+ * @file SupportMatrix.h
+ * @author Tim Luchterhand
+ * @date 18.10.26
+ * @brief This file contains the csp::SupportMatrix class which stores all allowed value pairs of a binary constraint
+ * as a bit matrix. A matrix is computed once when the csp::Csp is created and is shared by an arc and its reverse.
+ * During solving, supports are then found by table lookups instead of evaluating the constraint predicate.
+ */
+
+#ifndef CSP_SOLVER_SUPPORTMATRIX_H
+#define CSP_SOLVER_SUPPORTMATRIX_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+namespace csp {
+
+    /**
+     * Compiled binary constraint between two variables with integral values. Row a contains the allowed values of
+     * the second variable for value a of the first variable. The matrix also stores its transpose, so that both
+     * directions of the constraint can be checked row-wise. Only the values of the domains passed on construction are
+     * compiled. Use sourceCompiled() and targetCompiled() to check whether a value can be looked up.
+     * @tparam T Integral value type
+     */
+    template<typename T>
+    class SupportMatrix {
+    public:
+        using WordT = std::uint64_t;
+        static constexpr std::size_t WordBits = 64;
+
+        /**
+         * Range of values [offset, offset + size) covered by one dimension of the matrix
+         */
+        struct Universe {
+            T offset;
+            std::size_t size;
+
+            /// maximum ratio of universe size to domain size. Sparser domains get an empty universe
+            static constexpr std::size_t MaxSparsity = 64;
+
+            /**
+             * Creates the smallest universe containing all values of the given domain
+             * @tparam Domain Domain container type
+             * @param domain value domain
+             * @return Universe containing all values. Empty if the range of the values is much larger than the domain
+             */
+            template<typename Domain>
+            static auto of(const Domain &domain) -> Universe {
+                if (std::empty(domain)) {
+                    return {T{}, 0};
+                }
+
+                auto [min, max] = std::minmax_element(std::begin(domain), std::end(domain));
+                // computed in the unsigned type, so that the difference cannot overflow
+                const std::uintmax_t span = static_cast<std::uintmax_t>(*max) - static_cast<std::uintmax_t>(*min);
+                if (span >= MaxSparsity * std::size(domain)) {
+                    return {*min, 0};
+                }
+
+                return {*min, static_cast<std::size_t>(span) + 1};
+            }
+
+            [[nodiscard]] constexpr std::size_t words() const noexcept {
+                return (size + WordBits - 1) / WordBits;
+            }
+
+            [[nodiscard]] constexpr bool contains(T val) const noexcept {
+                // values below the offset wrap around and are outside of the universe as well
+                return static_cast<std::uintmax_t>(val) - static_cast<std::uintmax_t>(offset) < size;
+            }
+
+            [[nodiscard]] constexpr std::size_t index(T val) const noexcept {
+                return static_cast<std::size_t>(static_cast<std::uintmax_t>(val) -
+                                                static_cast<std::uintmax_t>(offset));
+            }
+        };
+
+        /**
+         * Ctor. Evaluates the predicate for all value pairs of the given domains
+         * @tparam Domain1 Domain type of the first variable
+         * @tparam Domain2 Domain type of the second variable
+         * @tparam Predicate Binary predicate type
+         * @param u1 universe of the first variable. Must contain all values in d1
+         * @param u2 universe of the second variable. Must contain all values in d2
+         * @param d1 value domain of the first variable
+         * @param d2 value domain of the second variable
+         * @param predicate constraint predicate. Is called with values from (d1, d2)
+         * @note values of d1 and d2 outside of the universes are not compiled
+         */
+        template<typename Domain1, typename Domain2, typename Predicate>
+        SupportMatrix(Universe u1, Universe u2, const Domain1 &d1, const Domain2 &d2, const Predicate &predicate) :
+                universes{u1, u2}, rows(u1.size * u2.words(), 0), columns(u2.size * u1.words(), 0),
+                uncompiled{missing(u1, d1), missing(u2, d2)} {
+            for (const auto &a : d1) {
+                for (const auto &b : d2) {
+                    if (u1.contains(a) && u2.contains(b) && predicate(a, b)) {
+                        std::size_t i = u1.index(a), j = u2.index(b);
+                        rows[i * u2.words() + j / WordBits] |= WordT(1) << (j % WordBits);
+                        columns[j * u1.words() + i / WordBits] |= WordT(1) << (i % WordBits);
+                    }
+                }
+            }
+        }
+
+        /**
+         * Universe of the source variable
+         * @param transposed whether the matrix is accessed in reverse direction
+         * @return value range of the rows
+         */
+        [[nodiscard]] constexpr auto sourceUniverse(bool transposed) const noexcept -> const Universe & {
+            return universes[transposed];
+        }
+
+        /**
+         * Universe of the destination variable
+         * @param transposed whether the matrix is accessed in reverse direction
+         * @return value range of the bits in a row
+         */
+        [[nodiscard]] constexpr auto targetUniverse(bool transposed) const noexcept -> const Universe & {
+            return universes[!transposed];
+        }
+
+        /**
+         * Gets the allowed values of the destination variable for the given value of the source variable
+         * @param val value of the source variable
+         * @param transposed whether the matrix is accessed in reverse direction
+         * @return pointer to targetUniverse(transposed).words() words, nullptr if val is outside of the universe
+         */
+        [[nodiscard]] const WordT *row(T val, bool transposed) const noexcept {
+            const Universe &source = sourceUniverse(transposed);
+            if (!source.contains(val)) {
+                return nullptr;
+            }
+
+            const auto &data = transposed ? columns : rows;
+            return data.data() + source.index(val) * targetUniverse(transposed).words();
+        }
+
+        /**
+         * Whether the given value of the source variable was compiled, i.e. whether its row is valid
+         * @param val value of the source variable
+         * @param transposed whether the matrix is accessed in reverse direction
+         * @return true if val was part of the source domain on construction
+         */
+        [[nodiscard]] bool sourceCompiled(T val, bool transposed) const noexcept {
+            return compiled(val, transposed);
+        }
+
+        /**
+         * Whether the given value of the destination variable was compiled, i.e. whether its bits are valid
+         * @param val value of the destination variable
+         * @param transposed whether the matrix is accessed in reverse direction
+         * @return true if val was part of the destination domain on construction
+         */
+        [[nodiscard]] bool targetCompiled(T val, bool transposed) const noexcept {
+            return compiled(val, !transposed);
+        }
+
+        /**
+         * Gets the values of the destination universe that were not compiled
+         * @param transposed whether the matrix is accessed in reverse direction
+         * @return pointer to targetUniverse(transposed).words() words with the same layout as a row
+         */
+        [[nodiscard]] const WordT *uncompiledTargets(bool transposed) const noexcept {
+            return uncompiled[!transposed].data();
+        }
+
+        /**
+         * Checks if a value of the destination variable is set in a row
+         * @param row row obtained from row()
+         * @param val value of the destination variable
+         * @param transposed whether the matrix is accessed in reverse direction
+         * @return true if bit of val is set. False if not or if val is outside of the destination universe
+         */
+        [[nodiscard]] bool test(const WordT *row, T val, bool transposed) const noexcept {
+            const Universe &target = targetUniverse(transposed);
+            if (!target.contains(val)) {
+                return false;
+            }
+
+            std::size_t j = target.index(val);
+            return (row[j / WordBits] >> (j % WordBits)) & 1u;
+        }
+
+    private:
+        template<typename Domain>
+        static auto missing(const Universe &universe, const Domain &domain) -> std::vector<WordT> {
+            std::vector<WordT> ret(universe.words(), ~WordT(0));
+            if (universe.size % WordBits != 0) {
+                ret.back() = (WordT(1) << (universe.size % WordBits)) - 1;
+            }
+
+            for (const auto &val : domain) {
+                if (universe.contains(val)) {
+                    const std::size_t i = universe.index(val);
+                    ret[i / WordBits] &= ~(WordT(1) << (i % WordBits));
+                }
+            }
+
+            return ret;
+        }
+
+        [[nodiscard]] bool compiled(T val, std::size_t dimension) const noexcept {
+            const Universe &universe = universes[dimension];
+            if (!universe.contains(val)) {
+                return false;
+            }
+
+            const std::size_t i = universe.index(val);
+            return !((uncompiled[dimension][i / WordBits] >> (i % WordBits)) & 1u);
+        }
+
+        Universe universes[2];
+        std::vector<WordT> rows;
+        std::vector<WordT> columns;
+        /// values of each universe that were not part of the domains on construction
+        std::vector<WordT> uncompiled[2];
+    };
+
+    /**
+     * Reference to the support matrix of an arc
+     */
+    struct ArcSupport {
+        /// index of the matrix in csp::Csp::supportMatrices
+        std::size_t matrix;
+        /// true if the arc points from the second to the first variable of the matrix
+        bool transposed;
+    };
+
+    /**
+     * Specifies how constraints are represented in a csp::Csp
+     */
+    enum class ConstraintMode {
+        /// Constraints are checked by evaluating their predicate
+        Predicate,
+        /// Each constraint is compiled into a csp::SupportMatrix. Requires integral values. Values that were not part of
+        /// the domains when the csp::Csp was created are checked using the predicate
+        Matrix
+    };
+}
+
+#endif //CSP_SOLVER_SUPPORTMATRIX_H
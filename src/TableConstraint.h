@@ -0,0 +1,368 @@
+/**
+ * @file TableConstraint.h
+ * @author Tim Luchterhand
+ * @date 18.10.26
+ * @brief This file contains the csp::TableConstraint class, an extensional constraint given by the list of its
+ * allowed tuples. The constraint is filtered using the Compact-Table algorithm: the currently valid tuples are stored
+ * in a reversible sparse bitset and each value has a precomputed bitset of the tuples it occurs in. Updating the
+ * table and searching supports are bitwise operations over the words of these bitsets.
+ */
+
+#ifndef CSP_SOLVER_TABLECONSTRAINT_H
+#define CSP_SOLVER_TABLECONSTRAINT_H
+
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <bit>
+#include <iterator>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <cassert>
+
+#include "Variable.h"
+#include "Trail.h"
+
+namespace csp {
+
+    /**
+     * Global constraint that allows exactly the given tuples of values. Can be added to a csp::ConstraintSet. Filtering
+     * removes every value that is not part of a valid tuple (generalized arc consistency). The set of valid tuples is
+     * stored in words that are saved to the trail, so that it is restored together with the value domains on
+     * backtracking. Changes of the value domains are detected by their sizes. Hence, below the root (choice point 0)
+     * all domain modifications have to be recorded in the trail. Domains that are restored otherwise (e.g. from a
+     * csp::util::CspCheckpoint) require filtering at the root, e.g. csp::util::Propagator::propagate with
+     * csp::util::NoTrail, which rebuilds the table. Debug builds check this requirement
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable. Values must be ordered by operator<
+     */
+    template<typename VarPtr>
+    class TableConstraint {
+    public:
+        using VarT = std::remove_reference_t<decltype(*std::declval<VarPtr>())>;
+        using ValueT = typename VarT::ValueT;
+        using VarListT = std::vector<VarPtr>;
+        using TupleT = std::vector<ValueT>;
+
+        /**
+         * Ctor
+         * @param variables variables of the constraint
+         * @param tuples allowed combinations of values, each containing one value for each variable in order of
+         * variables
+         * @throws std::invalid_argument if a tuple does not have one value for each variable
+         */
+        TableConstraint(VarListT variables, const std::vector<TupleT> &tuples) : vars(std::move(variables)),
+                numWords((tuples.size() + WordBits - 1) / WordBits), values(vars.size()), supports(vars.size()),
+                residues(vars.size()), words(numWords), wordStamps(numWords), lastSizes(vars.size()),
+                sizeStamps(vars.size()) {
+            for (const auto &tuple : tuples) {
+                if (tuple.size() != vars.size()) {
+                    throw std::invalid_argument("Tuple size does not match the number of variables");
+                }
+            }
+
+            for (std::size_t var = 0; var < vars.size(); ++var) {
+                auto &vals = values[var];
+                for (const auto &tuple : tuples) {
+                    vals.emplace_back(tuple[var]);
+                }
+
+                std::sort(vals.begin(), vals.end());
+                vals.erase(std::unique(vals.begin(), vals.end()), vals.end());
+                supports[var].assign(vals.size() * numWords, 0);
+                residues[var].assign(vals.size(), 0);
+                for (std::size_t t = 0; t < tuples.size(); ++t) {
+                    supports[var][valueIndex(var, tuples[t][var]) * numWords + t / WordBits] |=
+                            std::uint64_t(1) << (t % WordBits);
+                }
+            }
+
+            initialWords.assign(numWords, ~std::uint64_t(0));
+            if (tuples.size() % WordBits != 0) {
+                initialWords.back() = (std::uint64_t(1) << (tuples.size() % WordBits)) - 1;
+            }
+
+            reset();
+        }
+
+        [[nodiscard]] auto variables() const noexcept -> const VarListT & {
+            return vars;
+        }
+
+        /**
+         * Replaces the variables of the constraint, e.g. by their copies in a cloned csp::Csp (see csp::clone)
+         * @param variables new variables in order of variables()
+         */
+        void replaceVariables(const VarListT &variables) {
+            vars = variables;
+        }
+
+        /**
+         * Checks if the constraint is satisfied by the given values
+         * @param tuple one value for each variable in order of variables()
+         * @return true if the tuple is one of the allowed tuples
+         */
+        [[nodiscard]] bool satisfied(std::span<const ValueT> tuple) const {
+            for (std::size_t word = 0; word < numWords; ++word) {
+                std::uint64_t common = initialWords[word];
+                for (std::size_t var = 0; var < vars.size() && common != 0; ++var) {
+                    const std::size_t val = valueIndex(var, tuple[var]);
+                    common = val == None ? 0 : common & supports[var][val * numWords + word];
+                }
+
+                if (common != 0) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /**
+         * Restricts the valid tuples to the current value domains and removes all values without a valid tuple
+         * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+         * @param trail variables and the words of the table are saved to the trail before they are modified
+         * @param changed the position of each modified variable is appended
+         * @return false if no valid tuple is left
+         * @note below the root, all modifications of the value domains have to be recorded in trail
+         */
+        template<typename TrailT>
+        bool filter(TrailT &trail, std::vector<std::size_t> &changed) {
+            if (trail.choicePoint() == 0) {
+                // modifications are permanent and the domains may have been restored without the trail
+                reset();
+            }
+
+            assert(unchangedDomainsSupported() && "Value domain was modified below the root without the trail");
+
+            std::size_t numUpdated = 0;
+            std::size_t updated = 0;
+            for (std::size_t var = 0; var < vars.size(); ++var) {
+                const auto size = static_cast<std::uint64_t>(std::size(vars[var]->valueDomain()));
+                if (size == lastSizes[var]) {
+                    continue;
+                }
+
+                updateTable(trail, var);
+                if (limit == 0) {
+                    return false;
+                }
+
+                set(trail, lastSizes[var], sizeStamps[var], size);
+                ++numUpdated;
+                updated = var;
+            }
+
+            for (std::size_t var = 0; var < vars.size(); ++var) {
+                // values of a variable whose domain was the only restriction of the table still have valid tuples
+                if (numUpdated == 1 && var == updated) {
+                    continue;
+                }
+
+                if (filterDomain(trail, var)) {
+                    changed.emplace_back(var);
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * Number of valid tuples with respect to the value domains seen by the last call of filter()
+         * @return number of valid tuples
+         */
+        [[nodiscard]] std::size_t validTuples() const noexcept {
+            std::size_t ret = 0;
+            for (std::size_t i = 0; i < limit; ++i) {
+                ret += static_cast<std::size_t>(std::popcount(words[index[i]]));
+            }
+
+            return ret;
+        }
+
+    private:
+        static constexpr std::size_t WordBits = 64;
+        static constexpr std::size_t None = std::numeric_limits<std::size_t>::max();
+        static constexpr std::uint64_t UnknownSize = std::numeric_limits<std::uint64_t>::max();
+
+        [[nodiscard]] std::size_t valueIndex(std::size_t var, const ValueT &val) const {
+            const auto &vals = values[var];
+            auto it = std::lower_bound(vals.begin(), vals.end(), val);
+            if (it == vals.end() || val < *it) {
+                return None;
+            }
+
+            return static_cast<std::size_t>(it - vals.begin());
+        }
+
+        [[nodiscard]] const std::uint64_t *support(std::size_t var, std::size_t val) const noexcept {
+            return supports[var].data() + val * numWords;
+        }
+
+        /*
+         * Words are saved at most once per choice point. The order of the non-zero words in index does not have to be
+         * restored since removed words are only swapped behind limit
+         */
+        template<typename TrailT>
+        static void set(TrailT &trail, std::uint64_t &word, std::size_t &stamp, std::uint64_t value) {
+            if (stamp != trail.choicePoint()) {
+                trail.saveWord(word);
+                stamp = trail.choicePoint();
+            }
+
+            word = value;
+        }
+
+        void reset() {
+            words = initialWords;
+            index.resize(numWords);
+            for (std::size_t i = 0; i < numWords; ++i) {
+                index[i] = i;
+            }
+
+            limit = numWords;
+            lastSizes.assign(vars.size(), UnknownSize);
+            // choice point ids are only unique within the same trail
+            wordStamps.assign(numWords, 0);
+            limitStamp = 0;
+            sizeStamps.assign(vars.size(), 0);
+        }
+
+        /*
+         * Intersects the valid tuples with the union of the supports of the values in the domain of var. Only the
+         * non-zero words of the table are considered
+         */
+        template<typename TrailT>
+        void updateTable(TrailT &trail, std::size_t var) {
+            mask.assign(numWords, 0);
+            for (const auto &value : vars[var]->valueDomain()) {
+                const std::size_t val = valueIndex(var, value);
+                if (val == None) {
+                    continue;
+                }
+
+                const std::uint64_t *sup = support(var, val);
+                for (std::size_t i = 0; i < limit; ++i) {
+                    mask[index[i]] |= sup[index[i]];
+                }
+            }
+
+            for (std::size_t i = limit; i > 0; --i) {
+                const std::size_t offset = index[i - 1];
+                const std::uint64_t word = words[offset] & mask[offset];
+                if (word == words[offset]) {
+                    continue;
+                }
+
+                set(trail, words[offset], wordStamps[offset], word);
+                if (word == 0) {
+                    std::swap(index[i - 1], index[limit - 1]);
+                    set(trail, limit, limitStamp, limit - 1);
+                }
+            }
+        }
+
+        template<typename TrailT>
+        bool filterDomain(TrailT &trail, std::size_t var) {
+            auto &domain = vars[var]->valueDomain();
+            bool removed = false;
+            for (auto it = domain.begin(); it != domain.end();) {
+                if (hasSupport(var, *it)) {
+                    ++it;
+                    continue;
+                }
+
+                if (!removed) {
+                    trail.save(vars[var]);
+                    removed = true;
+                }
+
+                it = domain.erase(it);
+            }
+
+            if (removed) {
+                set(trail, lastSizes[var], sizeStamps[var], static_cast<std::uint64_t>(std::size(domain)));
+            }
+
+            return removed;
+        }
+
+        /*
+         * After each call of filter, all values have a valid tuple. A domain of unchanged size must still be the same
+         * domain, so this still holds unless the domain was replaced without the trail
+         */
+        [[nodiscard]] bool unchangedDomainsSupported() const {
+            for (std::size_t var = 0; var < vars.size(); ++var) {
+                const auto &domain = vars[var]->valueDomain();
+                if (static_cast<std::uint64_t>(std::size(domain)) != lastSizes[var]) {
+                    continue;
+                }
+
+                for (const auto &value : domain) {
+                    const std::size_t val = valueIndex(var, value);
+                    if (val == None) {
+                        return false;
+                    }
+
+                    const std::uint64_t *sup = support(var, val);
+                    bool supported = false;
+                    for (std::size_t i = 0; i < limit && !supported; ++i) {
+                        supported = (words[index[i]] & sup[index[i]]) != 0;
+                    }
+
+                    if (!supported) {
+                        return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        bool hasSupport(std::size_t var, const ValueT &value) {
+            const std::size_t val = valueIndex(var, value);
+            if (val == None) {
+                return false;
+            }
+
+            const std::uint64_t *sup = support(var, val);
+            std::size_t &residue = residues[var][val];
+            if ((words[residue] & sup[residue]) != 0) {
+                return true;
+            }
+
+            for (std::size_t i = 0; i < limit; ++i) {
+                if ((words[index[i]] & sup[index[i]]) != 0) {
+                    residue = index[i];
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        VarListT vars;
+        std::size_t numWords;
+        /// sorted values occurring in the tuples for each variable
+        std::vector<std::vector<ValueT>> values;
+        /// bitset of the tuples containing each value, numWords words per value
+        std::vector<std::vector<std::uint64_t>> supports;
+        /// word of the last found valid tuple of each value
+        std::vector<std::vector<std::size_t>> residues;
+        std::vector<std::uint64_t> initialWords;
+        // reversible sparse bitset of the valid tuples. The first limit entries of index are the non-zero words
+        std::vector<std::uint64_t> words;
+        std::vector<std::size_t> wordStamps;
+        std::vector<std::size_t> index;
+        std::uint64_t limit = 0;
+        std::size_t limitStamp = 0;
+        /// domain sizes seen by the last update of the table
+        std::vector<std::uint64_t> lastSizes;
+        std::vector<std::size_t> sizeStamps;
+        // buffer reused between calls of filter
+        std::vector<std::uint64_t> mask;
+    };
+}
+
+#endif //CSP_SOLVER_TABLECONSTRAINT_H
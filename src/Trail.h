@@ -0,0 +1,239 @@
+/**
+ * @file Trail.h
+ * @author Tim Luchterhand
+ * @date 18.10.26
+ * @brief This file contains the csp::util::Trail class which is used by the search algorithm to undo domain
+ * modifications on backtracking. Instead of backing up all value domains at every choice point, a domain is saved at
+ * most once per choice point and only if it is actually modified.
+ */
+
+#ifndef CSP_SOLVER_TRAIL_H
+#define CSP_SOLVER_TRAIL_H
+
+#include <vector>
+#include <unordered_map>
+#include <cassert>
+#include <type_traits>
+#include <iterator>
+#include <cstdint>
+
+namespace csp::util {
+
+    /**
+     * Undo log for value domains. Call push() at each choice point and save() before modifying a variable's value
+     * domain. pop() restores all domains modified since the matching push(). Global constraints with backtrackable
+     * state additionally save single words using saveWord(). Callers that know the index of the variable in the
+     * csp::Csp should pass it to save(), which avoids looking up the variable.
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     */
+    template<typename VarPtr>
+    class Trail {
+    public:
+        using VarT = std::remove_reference_t<decltype(*std::declval<VarPtr>())>;
+        using DomainT = typename VarT::DomainT;
+
+        /**
+         * Ctor
+         * @tparam Problem csp::Csp type
+         * @param problem The CSP whose variables are recorded
+         */
+        template<typename Problem>
+        explicit Trail(const Problem &problem) : stamps(problem.variables.size(), NoChoicePoint) {
+            varIds.reserve(problem.variables.size());
+            for (std::size_t i = 0; i < problem.variables.size(); ++i) {
+                varIds.emplace(&*problem.variables[i], i);
+            }
+        }
+
+        /**
+         * Opens a new choice point
+         */
+        void push() {
+            marks.emplace_back(Mark{entries.size(), words.size(), ++lastId});
+        }
+
+        /**
+         * Restores all value domains that were saved since the last call to push() and closes the choice point
+         */
+        void pop() {
+            pop([](std::size_t) {});
+        }
+
+        /**
+         * Restores all value domains that were saved since the last call to push() and closes the choice point
+         * @tparam OnRestore Callable type
+         * @param onRestore is called with the index of each restored variable after its domain was restored
+         */
+        template<typename OnRestore>
+        void pop(OnRestore &&onRestore) {
+            assert(!marks.empty());
+            const std::size_t begin = marks.back().begin;
+            while (entries.size() > begin) {
+                auto &entry = entries.back();
+                entry.var->setValueDomain(std::move(entry.domain));
+                onRestore(entry.varId);
+                entries.pop_back();
+            }
+
+            const std::size_t wordsBegin = marks.back().wordsBegin;
+            while (words.size() > wordsBegin) {
+                *words.back().word = words.back().value;
+                words.pop_back();
+            }
+
+            marks.pop_back();
+        }
+
+        /**
+         * Calls the given function for each variable that was saved since the last call to push()
+         * @tparam F Callable type
+         * @param f is called with the index of each saved variable
+         */
+        template<typename F>
+        void forEachSaved(F &&f) const {
+            if (marks.empty()) {
+                return;
+            }
+
+            for (std::size_t i = marks.back().begin; i < entries.size(); ++i) {
+                f(entries[i].varId);
+            }
+        }
+
+        /**
+         * Records the current value domain of var. Must be called before the domain is modified. Only the first call
+         * per variable and choice point actually copies the domain.
+         * @param varId index of var in the csp::Csp
+         * @param var variable that is about to be modified
+         */
+        void save(std::size_t varId, const VarPtr &var) {
+            assert(varId < stamps.size() && varIds.at(&*var) == varId);
+            if (marks.empty() || stamps[varId] == marks.back().id) {
+                return;
+            }
+
+            stamps[varId] = marks.back().id;
+            entries.emplace_back(Entry{&*var, varId, var->valueDomain()});
+        }
+
+        /**
+         * Records the current value domain of var (see save(varId, var)). Looks up the index of the variable
+         * @param var variable that is about to be modified
+         */
+        void save(const VarPtr &var) {
+            if (marks.empty()) {
+                return;
+            }
+
+            auto it = varIds.find(&*var);
+            assert(it != varIds.end());
+            save(it->second, var);
+        }
+
+        /**
+         * Records the current value of a word that belongs to the reversible state of a constraint (e.g. a sparse
+         * bitset). Must be called before the word is modified. The word is restored by the matching pop(). Unlike
+         * save(), each call creates a new entry. Use choicePoint() to avoid saving a word twice per choice point
+         * @param word word that is about to be modified. Must stay at the same address until it is restored
+         */
+        void saveWord(std::uint64_t &word) {
+            if (marks.empty()) {
+                return;
+            }
+
+            words.emplace_back(WordEntry{&word, word});
+        }
+
+        /**
+         * Id of the innermost open choice point. Ids are unique within this trail and never reused
+         * @return choice point id, 0 if no choice point is open
+         */
+        [[nodiscard]] std::size_t choicePoint() const noexcept {
+            return marks.empty() ? NoChoicePoint : marks.back().id;
+        }
+
+        /**
+         * Number of currently open choice points
+         * @return search depth
+         */
+        [[nodiscard]] std::size_t depth() const noexcept {
+            return marks.size();
+        }
+
+        /**
+         * Approximate memory of the value domains saved since the last call to push()
+         * @return number of bytes
+         */
+        [[nodiscard]] std::size_t savedBytes() const noexcept {
+            if (marks.empty()) {
+                return 0;
+            }
+
+            std::size_t ret = 0;
+            for (std::size_t i = marks.back().begin; i < entries.size(); ++i) {
+                ret += sizeof(DomainT);
+                if constexpr (!std::is_trivially_copyable_v<DomainT>) {
+                    // node based and dynamic containers store their values on the heap
+                    ret += std::size(entries[i].domain) * sizeof(typename VarT::ValueT);
+                }
+            }
+
+            return ret;
+        }
+
+        /**
+         * Number of saved value domains
+         * @return trail size
+         */
+        [[nodiscard]] std::size_t size() const noexcept {
+            return entries.size();
+        }
+
+    private:
+        static constexpr std::size_t NoChoicePoint = 0;
+
+        struct Entry {
+            VarT *var;
+            std::size_t varId;
+            DomainT domain;
+        };
+
+        struct WordEntry {
+            std::uint64_t *word;
+            std::uint64_t value;
+        };
+
+        struct Mark {
+            std::size_t begin;
+            std::size_t wordsBegin;
+            std::size_t id;
+        };
+
+        std::vector<Entry> entries;
+        std::vector<WordEntry> words;
+        std::vector<Mark> marks;
+        /// choice point in which each variable was saved last
+        std::vector<std::size_t> stamps;
+        std::unordered_map<const VarT *, std::size_t> varIds;
+        std::size_t lastId = NoChoicePoint;
+    };
+
+    /**
+     * Trail type that does not record anything. Used when domain modifications do not have to be undone.
+     */
+    struct NoTrail {
+        template<typename VarPtr>
+        constexpr void save(const VarPtr &) const noexcept {}
+
+        template<typename VarPtr>
+        constexpr void save(std::size_t, const VarPtr &) const noexcept {}
+
+        constexpr void saveWord(std::uint64_t &) const noexcept {}
+
+        [[nodiscard]] constexpr std::size_t choicePoint() const noexcept {
+            return 0;
+        }
+    };
+}
+
+#endif //CSP_SOLVER_TRAIL_H
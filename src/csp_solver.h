@@ -10,77 +10,705 @@
 #define CSP_SOLVER_CSP_SOLVER_H
 
 #include <type_traits>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <limits>
+#include <optional>
 
 #include "Variable.h"
+#include "BitsetDomain.h"
 #include "Arc.h"
 #include "util.h"
+#include "Trail.h"
+#include "Propagator.h"
 #include "strategies.h"
+#include "AllDifferent.h"
+#include "NaryConstraint.h"
+#include "TableConstraint.h"
+#include "SolveStats.h"
+#include "SearchLimit.h"
 
 namespace csp {
+
+    /**
+     * Configuration of the solving algorithm
+     */
+    struct SolverOptions {
+        /// Arc consistency algorithm used during search
+        Propagation propagation = Propagation::Ac3;
+        /// Use conflict-directed backjumping instead of chronological backtracking. The decisions that caused each
+        /// domain reduction are tracked, which makes propagation more expensive but avoids thrashing on failures that
+        /// were caused by decisions far up in the search tree
+        bool backjumping = false;
+        /// Maximum number of nogoods stored during backjumping (the oldest one is replaced). 0 disables nogoods
+        std::size_t nogoodLimit = 1000;
+        /// Restart policy. Learned state (csp::strategies::DomWdeg weights and nogoods) is kept across restarts.
+        /// Restarts are only useful with a randomized strategy or value order, e.g. csp::strategies::Mrv(seed)
+        Restarts restarts = Restarts::None;
+        /// Number of backtracks of the first run before a restart
+        std::size_t restartBase = 100;
+        /// Growth factor of the cutoff with each restart if restarts == Restarts::Geometric
+        double restartGrowth = 1.5;
+        /// Deadline, node and propagation limits and cancellation of the search. Unlimited by default
+        SearchLimits limits;
+    };
+
+    /**
+     * Result of a search that may be aborted (see csp::trySolve)
+     */
+    enum class SolveResult {
+        /// a solution was found
+        Solved,
+        /// the problem has no solution
+        Unsatisfiable,
+        /// a limit was reached or the search was cancelled before the search was finished
+        Aborted
+    };
+
     namespace util {
+        /**
+         * Pruning function object that never prunes. Used when the search is not bounded
+         */
+        struct NoPruning {
+            template<typename Problem>
+            constexpr bool operator()(const Problem &) const noexcept {
+                return false;
+            }
+        };
+
+        /**
+         * Splitting policy that never hands open choice points to other workers. Used by the sequential search
+         */
+        struct NoSplit {
+            [[nodiscard]] constexpr bool wantsWork() const noexcept {
+                return false;
+            }
+
+            template<typename Problem, typename ValueIt>
+            constexpr void publish(const Problem &, std::size_t, ValueIt, ValueIt) const noexcept {}
+        };
+
         /**
          * Recursive backtracking search for csp::Csps. Prefer using the wrapper function csp::solve
          * @tparam VarPtr Pointer-type to a type derived from csp::Variable
          * @tparam Strategy Type of value selection strategy during search
+         * @tparam ValueOrder Type of the value order (see csp::type_traits::is_value_order)
          * @param problem CSP to be solved
-         * @param strategy value selection strategy object used during during search
-         * @return True if problem was solved, false otherwise
+         * @param strategy value selection strategy object used during during search. Stateful strategies are informed about
+         * all domain changes
+         * @param valueOrder decides in which order the values of the chosen variable are tried
+         * @param propagator propagator of the problem used to obtain arc consistency after each assignment
+         * @param trail undo log used to restore the value domains on backtracking
+         * @param stats search statistics (csp::SolveStats or csp::util::NoStats)
+         * @param onSolution is called for each solution. Returns true if the search should stop, false if it should
+         * continue with the next solution
+         * @param prune is called with the problem after each consistent propagation. Returns true if the subtree cannot
+         * contain a solution that is of interest (e.g. bound of branch-and-bound)
+         * @param backjumping conflict analysis (csp::util::Backjumping or csp::util::NoBackjumping for chronological
+         * backtracking)
+         * @param limit counts the nodes and backtracks. If the search is interrupted by the restart policy or aborted,
+         * it returns to the root without finishing the subtrees
+         * @param split hands the remaining values of a choice point to other workers if wantsWork() returns true
+         * (csp::util::NoSplit for the sequential search). Must be used with csp::util::NoBackjumping
+         * @return True if the search was stopped at a solution, false otherwise
          */
-        template<typename VarPtr, typename Strategy>
-        bool recursiveSolve(Csp<VarPtr> &problem, const Strategy &strategy) {
+        template<typename VarPtr, typename Strategy, typename ValueOrder, typename StatsT, typename OnSolution,
+                typename Prune, typename BackjumpT, typename Split>
+        bool recursiveSolve(Csp<VarPtr> &problem, Strategy &strategy, const ValueOrder &valueOrder,
+                            Propagator<VarPtr> &propagator, Trail<VarPtr> &trail, StatsT &stats,
+                            OnSolution &onSolution, const Prune &prune, BackjumpT &backjumping, SearchLimit &limit,
+                            Split &split) {
+            constexpr bool collectStats = type_traits::collects_stats<StatsT>::value;
+            constexpr bool stateful = !std::is_const_v<Strategy> &&
+                                      type_traits::is_stateful_strategy<Strategy, Csp<VarPtr>>::value;
+            constexpr bool conflictAware = stateful &&
+                                           type_traits::is_conflict_aware_strategy<Strategy, Csp<VarPtr>>::value;
+            constexpr bool cbj = !std::is_same_v<BackjumpT, NoBackjumping>;
+            constexpr bool parallel = !std::is_same_v<Split, NoSplit>;
+            static_assert(!cbj || !parallel, "Backjumping is not supported by the parallel search");
             using Domain = typename Csp<VarPtr>::VarT::DomainT;
+            using ValueT = typename Csp<VarPtr>::VarT::ValueT;
+            const std::size_t depth = trail.depth();
+            if constexpr (cbj) {
+                backjumping.beginNode(depth);
+            }
+
             VarPtr nextVar = strategy(problem);
             if (nextVar->isAssigned()) {
-                return true;
+                if constexpr (collectStats) {
+                    ++stats.solutions;
+                }
+
+                const bool stop = onSolution();
+                if constexpr (cbj) {
+                    if (!stop) {
+                        // the search continues, so this node has to be revisited chronologically
+                        backjumping.failAll(depth);
+                    }
+                }
+
+                return stop;
             }
 
-            //Moving storage as it will be overwritten by assign() anyway
-            Domain valueDomain = std::move(nextVar->valueDomain());
-            for (auto &val : valueDomain) {
-                nextVar->assign(std::move(val));
-                // Back up value domains of all variables. This is considerably faster than creating a deep copy of the
-                // whole Csp
-                auto cp = util::makeCspCheckpoint(problem);
-                if (!util::ac3(problem)) {
-                    util::restoreCspFromCheckpoint(problem, cp);
-                    continue;
+            const std::size_t varId = problem.varIds.at(nextVar);
+            // Only the domain of the chosen variable is copied here. All other modifications are undone through the
+            // trail which only contains the domains that were actually changed below this choice point
+            const auto values = [&]() {
+                if constexpr (std::is_same_v<ValueOrder, strategies::DomainOrder>) {
+                    return Domain(nextVar->valueDomain());
+                } else {
+                    const Domain &domain = nextVar->valueDomain();
+                    std::vector<ValueT> ret(std::begin(domain), std::end(domain));
+                    valueOrder(problem, varId, ret);
+                    return ret;
+                }
+            }();
+
+            [[maybe_unused]] std::size_t next = 0;
+            for (const auto &val : values) {
+                if (limit.onNode()) {
+                    return false;
+                }
+
+                bool handedOff = false;
+                if constexpr (parallel) {
+                    // the remaining values are searched by other workers, this worker only tries val
+                    if (++next < std::size(values) && split.wantsWork()) {
+                        split.publish(static_cast<const Csp<VarPtr> &>(problem), varId,
+                                      std::next(std::begin(values), static_cast<std::ptrdiff_t>(next)),
+                                      std::end(values));
+                        handedOff = true;
+                    }
+                }
+
+                trail.push();
+                trail.save(varId, nextVar);
+                nextVar->assign(val);
+                if constexpr (cbj) {
+                    backjumping.decide(varId, val, trail);
+                }
+
+                if constexpr (collectStats) {
+                    ++stats.nodes;
+                    stats.maxDepth = std::max(stats.maxDepth, trail.depth());
+                }
+
+                // The problem was arc consistent before the assignment, so only arcs pointing to nextVar need to
+                // be revised initially
+                const bool propagated = propagator.propagateFrom(varId, trail, stats);
+                bool consistent = propagated;
+                if constexpr (cbj) {
+                    if (!propagated) {
+                        backjumping.explainConflict(propagator.conflictArc());
+                    } else {
+                        consistent = backjumping.propagate(propagator, trail, stats);
+                    }
+                }
+
+                if constexpr (collectStats) {
+                    stats.checkpointBytes += trail.savedBytes();
                 }
 
-                if (recursiveSolve(problem, strategy)) {
+                if constexpr (stateful) {
+                    if (consistent) {
+                        trail.forEachSaved([&problem, &strategy](std::size_t id) {
+                            strategy.onDomainChanged(problem, id);
+                        });
+                    } else if constexpr (conflictAware) {
+                        if (!propagated && !limit.aborted()) {
+                            strategy.onConflict(problem, propagator.conflictArc());
+                        }
+                    }
+                }
+
+                const bool pruned = consistent && prune(static_cast<const Csp<VarPtr> &>(problem));
+                if (consistent && !pruned && recursiveSolve(problem, strategy, valueOrder, propagator, trail, stats,
+                                                            onSolution, prune, backjumping, limit, split)) {
                     return true;
                 }
 
-                util::restoreCspFromCheckpoint(problem, cp);
+                const bool interrupted = limit.interrupted();
+                bool jump = false;
+                if constexpr (cbj) {
+                    // an interrupted subtree was not refuted, so there is no conflict to analyze
+                    if (!interrupted) {
+                        if (!consistent) {
+                            backjumping.onFailure(depth);
+                        } else if (pruned) {
+                            backjumping.failAll(depth);
+                        } else {
+                            jump = backjumping.backjump(depth);
+                        }
+                    }
+                }
+
+                if constexpr (collectStats) {
+                    ++stats.backtracks;
+                    stats.backjumps += jump;
+                }
+
+                if constexpr (stateful) {
+                    trail.pop([&problem, &strategy](std::size_t id) { strategy.onDomainChanged(problem, id); });
+                } else {
+                    trail.pop();
+                }
+
+                if (interrupted || jump || limit.onBacktrack() || handedOff) {
+                    return false;
+                }
+            }
+
+            if constexpr (cbj) {
+                const bool learned = backjumping.learn(depth);
+                if constexpr (collectStats) {
+                    stats.nogoods += learned;
+                }
             }
 
             return false;
         }
 
+        /**
+         * Solves a CSP (see csp::solve)
+         * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+         * @tparam Strategy Type of value selection strategy during search
+         * @tparam ValueOrder Type of the value order
+         * @tparam StatsT Type of the statistics (csp::SolveStats or csp::util::NoStats)
+         * @param problem CSP to be solved
+         * @param strategy variable selection strategy
+         * @param valueOrder value order during search
+         * @param options configuration of the solving algorithm
+         * @param stats search statistics
+         * @param onSolution is called for each solution. Returns true if the search should stop
+         * @param prune is called after each consistent propagation. Returns true if the subtree should be skipped
+         * @return SolveResult::Solved if the search was stopped at a solution, SolveResult::Aborted if a limit was
+         * reached, SolveResult::Unsatisfiable otherwise
+         */
+        template<typename VarPtr, typename Strategy, typename ValueOrder, typename StatsT, typename OnSolution,
+                typename Prune = NoPruning>
+        SolveResult solveImpl(Csp<VarPtr> &problem, const Strategy &strategy, const ValueOrder &valueOrder,
+                       const SolverOptions &options, StatsT &stats, OnSolution &&onSolution,
+                       const Prune &prune = Prune()) {
+            static_assert(std::is_invocable_r_v<VarPtr, Strategy, Csp<VarPtr>>,
+                          "Invalid strategy object! Must map from csp::Csp -> VarPtr");
+            static_assert(type_traits::is_value_order<ValueOrder, Csp<VarPtr>>::value,
+                          "Invalid value order! Must be callable with (csp::Csp, varId, std::vector<ValueT> &)");
+            if (std::empty(problem.variables)) {
+                return onSolution() ? SolveResult::Solved : SolveResult::Unsatisfiable;
+            }
+
+            Propagator<VarPtr> propagator(problem, options.propagation);
+            SearchLimit limit(options.restarts, options.restartBase, options.restartGrowth, options.limits);
+            if (limit.limitsPropagation()) {
+                propagator.limitWith(&limit);
+            }
+
+            NoTrail noTrail;
+            if (!propagator.propagate(noTrail, stats)) {
+                return limit.aborted() ? SolveResult::Aborted : SolveResult::Unsatisfiable;
+            }
+
+            if (prune(static_cast<const Csp<VarPtr> &>(problem))) {
+                return SolveResult::Unsatisfiable;
+            }
+
+            Trail<VarPtr> trail(problem);
+            // the strategy and the conflict analysis live outside of the restart loop, so that learned weights and
+            // nogoods survive restarts
+            auto runs = [&](auto &searchStrategy, auto &backjumping) {
+                NoSplit noSplit;
+                while (true) {
+                    if (recursiveSolve(problem, searchStrategy, valueOrder, propagator, trail, stats, onSolution, prune,
+                                       backjumping, limit, noSplit)) {
+                        return true;
+                    }
+
+                    if (!limit.restart()) {
+                        return false;
+                    }
+
+                    if constexpr (type_traits::collects_stats<StatsT>::value) {
+                        ++stats.restarts;
+                    }
+                }
+            };
+
+            auto searchWith = [&](auto &searchStrategy, auto &backjumping) {
+                if constexpr (type_traits::collects_stats<StatsT>::value) {
+                    const auto propagationBefore = stats.propagationTime;
+                    const auto start = std::chrono::steady_clock::now();
+                    const bool ret = runs(searchStrategy, backjumping);
+                    const auto searchTime = std::chrono::steady_clock::now() - start;
+                    stats.branchingTime += std::chrono::duration_cast<std::chrono::nanoseconds>(searchTime) -
+                                           (stats.propagationTime - propagationBefore);
+                    return ret;
+                } else {
+                    return runs(searchStrategy, backjumping);
+                }
+            };
+
+            auto search = [&](auto &searchStrategy) {
+                if (options.backjumping) {
+                    Backjumping<VarPtr> backjumping(problem, options.nogoodLimit);
+                    propagator.explainWith(&backjumping);
+                    return searchWith(searchStrategy, backjumping);
+                }
+
+                NoBackjumping none;
+                return searchWith(searchStrategy, none);
+            };
+
+            const bool solved = [&]() {
+                if constexpr (type_traits::is_stateful_strategy<Strategy, Csp<VarPtr>>::value) {
+                    // the caller's strategy object is not modified
+                    Strategy searchStrategy(strategy);
+                    searchStrategy.init(problem);
+                    return search(searchStrategy);
+                } else {
+                    return search(strategy);
+                }
+            }();
+
+            if (solved) {
+                return SolveResult::Solved;
+            }
+
+            return limit.aborted() ? SolveResult::Aborted : SolveResult::Unsatisfiable;
+        }
+
+        /**
+         * Function object used by csp::solve which stops the search at the first solution
+         */
+        struct StopAtFirst {
+            constexpr bool operator()() const noexcept {
+                return true;
+            }
+        };
     }
 
     /**
      * Solves a CSP. If a solution exists, the value domains of each variable in the given Csp will be reduced to
      * exactly one value. If multiple solutions exist, it is unspecified which is found. If no solution exists, false
-     * is returned but the value domains of the variables might still be altered
+     * is returned but the value domains of the variables might still be altered. False is also returned if the search
+     * was aborted by one of the SolverOptions::limits (use csp::trySolve to tell both cases apart)
      * @tparam VarPtr Pointer-type to a type derived from csp::Variable
      * @tparam Strategy Type of value selection strategy during search (default: minimum remaining values strategy).
      * Has to provide ()-Operator and return VarPtr from given csp::Csp
      * @param problem CSP to be solved
+     * @param strategy variable selection strategy
+     * @param options configuration of the solving algorithm
+     * @return True if problem was solved, false otherwise
+     */
+    template<typename VarPtr, typename Strategy = strategies::Mrv<VarPtr>>
+    bool solve(Csp<VarPtr> &problem, const Strategy &strategy = Strategy(), const SolverOptions &options = {}) {
+        util::NoStats stats;
+        return util::solveImpl(problem, strategy, strategies::DomainOrder(), options, stats, util::StopAtFirst()) ==
+               SolveResult::Solved;
+    }
+
+    /**
+     * Solves a CSP trying the values of each chosen variable in the order given by a value order (see csp::solve)
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam Strategy Type of value selection strategy during search
+     * @tparam ValueOrder Type of the value order (see csp::type_traits::is_value_order)
+     * @param problem CSP to be solved
+     * @param strategy variable selection strategy
+     * @param valueOrder value order, e.g. csp::strategies::LeastConstrainingValue
+     * @param options configuration of the solving algorithm
+     * @return True if problem was solved, false otherwise
+     */
+    template<typename VarPtr, typename Strategy, typename ValueOrder,
+            std::enable_if_t<type_traits::is_value_order<ValueOrder, Csp<VarPtr>>::value, int> = 0>
+    bool solve(Csp<VarPtr> &problem, const Strategy &strategy, const ValueOrder &valueOrder,
+               const SolverOptions &options = {}) {
+        util::NoStats stats;
+        return util::solveImpl(problem, strategy, valueOrder, options, stats, util::StopAtFirst()) ==
+               SolveResult::Solved;
+    }
+
+    /**
+     * Solves a CSP and collects statistics about the search (see csp::solve)
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam Strategy Type of value selection strategy during search
+     * @param problem CSP to be solved
+     * @param strategy variable selection strategy
+     * @param options configuration of the solving algorithm
+     * @param stats statistics of the search are added to stats
+     * @return True if problem was solved, false otherwise
+     * @note Without csp::SolveStats, no statistics code is compiled into the solver
+     */
+    template<typename VarPtr, typename Strategy>
+    bool solve(Csp<VarPtr> &problem, const Strategy &strategy, const SolverOptions &options, SolveStats &stats) {
+        return util::solveImpl(problem, strategy, strategies::DomainOrder(), options, stats, util::StopAtFirst()) ==
+               SolveResult::Solved;
+    }
+
+    /**
+     * Solves a CSP using a value order and collects statistics about the search (see csp::solve)
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam Strategy Type of value selection strategy during search
+     * @tparam ValueOrder Type of the value order (see csp::type_traits::is_value_order)
+     * @param problem CSP to be solved
+     * @param strategy variable selection strategy
+     * @param valueOrder value order
+     * @param options configuration of the solving algorithm
+     * @param stats statistics of the search are added to stats
      * @return True if problem was solved, false otherwise
      */
+    template<typename VarPtr, typename Strategy, typename ValueOrder,
+            std::enable_if_t<type_traits::is_value_order<ValueOrder, Csp<VarPtr>>::value, int> = 0>
+    bool solve(Csp<VarPtr> &problem, const Strategy &strategy, const ValueOrder &valueOrder,
+               const SolverOptions &options, SolveStats &stats) {
+        return util::solveImpl(problem, strategy, valueOrder, options, stats, util::StopAtFirst()) ==
+               SolveResult::Solved;
+    }
+
+    /**
+     * Solves a CSP within the limits given by SolverOptions::limits (see csp::solve). If the search is aborted, the
+     * value domains are left in the state after the initial propagation, i.e. all values that were removed are not part
+     * of any solution
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam Strategy Type of value selection strategy during search
+     * @param problem CSP to be solved
+     * @param strategy variable selection strategy
+     * @param options configuration of the solving algorithm including the limits of the search
+     * @return whether the problem was solved, is unsatisfiable or the search was aborted
+     */
+    template<typename VarPtr, typename Strategy = strategies::Mrv<VarPtr>>
+    SolveResult trySolve(Csp<VarPtr> &problem, const Strategy &strategy = Strategy(),
+                         const SolverOptions &options = {}) {
+        util::NoStats stats;
+        return util::solveImpl(problem, strategy, strategies::DomainOrder(), options, stats, util::StopAtFirst());
+    }
+
+    /**
+     * Solves a CSP within the limits given by SolverOptions::limits using a value order and collects statistics about
+     * the search (see csp::trySolve)
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam Strategy Type of value selection strategy during search
+     * @tparam ValueOrder Type of the value order (see csp::type_traits::is_value_order)
+     * @param problem CSP to be solved
+     * @param strategy variable selection strategy
+     * @param valueOrder value order
+     * @param options configuration of the solving algorithm including the limits of the search
+     * @param stats statistics of the search are added to stats
+     * @return whether the problem was solved, is unsatisfiable or the search was aborted
+     */
+    template<typename VarPtr, typename Strategy, typename ValueOrder,
+            std::enable_if_t<type_traits::is_value_order<ValueOrder, Csp<VarPtr>>::value, int> = 0>
+    SolveResult trySolve(Csp<VarPtr> &problem, const Strategy &strategy, const ValueOrder &valueOrder,
+                         const SolverOptions &options, SolveStats &stats) {
+        return util::solveImpl(problem, strategy, valueOrder, options, stats, util::StopAtFirst());
+    }
+
+    /**
+     * Enumerates the solutions of a CSP. The search continues after each solution instead of restarting. While the
+     * callback is executed, each variable of the problem is assigned to exactly one value. If the enumeration is
+     * stopped by the callback, the variables remain assigned to the last solution. Otherwise, all value domains are
+     * restored to the state after the initial propagation. The enumeration also stops if one of the
+     * SolverOptions::limits is reached
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam OnSolution Type of the callback. Is called with the csp::Csp and returns either void or bool
+     * @tparam Strategy Type of value selection strategy during search
+     * @param problem CSP whose solutions are enumerated
+     * @param onSolution is called for each solution. If it returns bool, false stops the enumeration
+     * @param strategy variable selection strategy
+     * @param options configuration of the solving algorithm. Restarts are ignored
+     * @return number of solutions passed to the callback
+     */
+    template<typename VarPtr, typename OnSolution, typename Strategy = strategies::Mrv<VarPtr>>
+    std::size_t enumerateSolutions(Csp<VarPtr> &problem, OnSolution &&onSolution, const Strategy &strategy = Strategy(),
+                                   const SolverOptions &options = {}) {
+        static_assert(std::is_invocable_v<OnSolution, const Csp<VarPtr> &>,
+                      "Invalid callback! Must be callable with csp::Csp");
+        // restarts would revisit solutions
+        SolverOptions exhaustive = options;
+        exhaustive.restarts = Restarts::None;
+        util::NoStats stats;
+        std::size_t count = 0;
+        util::solveImpl(problem, strategy, strategies::DomainOrder(), exhaustive, stats, [&]() {
+            ++count;
+            if constexpr (std::is_same_v<std::invoke_result_t<OnSolution, const Csp<VarPtr> &>, void>) {
+                onSolution(static_cast<const Csp<VarPtr> &>(problem));
+                return false;
+            } else {
+                return !onSolution(static_cast<const Csp<VarPtr> &>(problem));
+            }
+        });
+
+        return count;
+    }
+
+    /**
+     * Counts the solutions of a CSP. Useful to check if a problem has a unique solution (limit = 2)
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam Strategy Type of value selection strategy during search
+     * @param problem CSP whose solutions are counted
+     * @param limit the search stops as soon as this many solutions were found
+     * @param strategy variable selection strategy
+     * @param options configuration of the solving algorithm. Restarts are ignored
+     * @return number of solutions, at most limit. Only a lower bound if one of the SolverOptions::limits was reached
+     * @note the value domains are left as described in csp::enumerateSolutions
+     */
     template<typename VarPtr, typename Strategy = strategies::Mrv<VarPtr>>
-    bool solve(Csp<VarPtr> &problem, const Strategy &strategy = Strategy()) {
-        static_assert(std::is_invocable_r_v<VarPtr, Strategy, Csp<VarPtr>>,
-                "Invalid strategy object! Must map from csp::Csp -> VarPtr");
-        if (std::empty(problem.variables)) {
-            return true;
+    std::size_t countSolutions(Csp<VarPtr> &problem, std::size_t limit = std::numeric_limits<std::size_t>::max(),
+                               const Strategy &strategy = Strategy(), const SolverOptions &options = {}) {
+        if (limit == 0) {
+            return 0;
+        }
+
+        SolverOptions exhaustive = options;
+        exhaustive.restarts = Restarts::None;
+        util::NoStats stats;
+        std::size_t count = 0;
+        util::solveImpl(problem, strategy, strategies::DomainOrder(), exhaustive, stats, [&count, limit]() {
+            return ++count == limit;
+        });
+
+        return count;
+    }
+
+    /**
+     * Result of an optimization (see csp::tryMinimize)
+     * @tparam CostT Type of the cost of a solution
+     */
+    template<typename CostT>
+    struct OptimizeResult {
+        /// SolveResult::Solved if the cost is optimal, SolveResult::Unsatisfiable if the problem has no solution,
+        /// SolveResult::Aborted if a limit was reached or the search was cancelled
+        SolveResult result;
+        /// cost of the best solution found. Only optimal if result is SolveResult::Solved
+        std::optional<CostT> cost;
+    };
+
+    /**
+     * Finds a solution of a CSP that minimizes an objective using branch-and-bound within the limits given by
+     * SolverOptions::limits. Each solution found tightens the bound. Subtrees are pruned using the lower bound
+     * callback, which receives the partially assigned problem after propagation and returns a lower bound of the
+     * objective over all solutions in the subtree. If a solution was found, the value domains of the variables are
+     * reduced to the best solution, even if the search was aborted. Otherwise, the domains are left as they were after
+     * the initial propagation
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam Objective Type of the objective. Is called with the fully assigned csp::Csp and returns a cost that is
+     * ordered by operator<
+     * @tparam LowerBound Type of the lower bound. Is called with the csp::Csp and returns the same cost type
+     * @tparam Strategy Type of value selection strategy during search
+     * @param problem CSP to be optimized
+     * @param objective cost of a solution
+     * @param lowerBound lower bound of the cost of all solutions in the current subtree. Must never overestimate.
+     * csp::util::NoPruning disables pruning
+     * @param strategy variable selection strategy
+     * @param options configuration of the solving algorithm including the limits of the search
+     * @return csp::OptimizeResult. The cost is optimal if the result is SolveResult::Solved. If the search was
+     * aborted, the cost of the best solution found so far is returned, if any
+     */
+    template<typename VarPtr, typename Objective, typename LowerBound, typename Strategy>
+    auto tryMinimize(Csp<VarPtr> &problem, const Objective &objective, const LowerBound &lowerBound,
+                     const Strategy &strategy, const SolverOptions &options = {}) {
+        using CostT = std::decay_t<std::invoke_result_t<const Objective &, const Csp<VarPtr> &>>;
+        using ValueT = typename Csp<VarPtr>::VarT::ValueT;
+        constexpr bool bounded = !std::is_same_v<LowerBound, util::NoPruning>;
+        if constexpr (bounded) {
+            static_assert(std::is_convertible_v<std::invoke_result_t<const LowerBound &, const Csp<VarPtr> &>, CostT>,
+                          "Invalid lower bound! Must map from csp::Csp -> cost of the objective");
         }
 
-        if (!util::ac3(problem)) {
+        std::optional<CostT> best;
+        std::vector<ValueT> bestValues;
+        auto onSolution = [&]() {
+            CostT cost = objective(static_cast<const Csp<VarPtr> &>(problem));
+            if (!best.has_value() || cost < *best) {
+                best = std::move(cost);
+                bestValues.clear();
+                for (const auto &var : problem.variables) {
+                    bestValues.emplace_back(var->valueDomain().front());
+                }
+            }
+
             return false;
+        };
+
+        util::NoStats stats;
+        SolveResult result;
+        if constexpr (bounded) {
+            auto prune = [&](const Csp<VarPtr> &p) { return best.has_value() && !(lowerBound(p) < *best); };
+            result = util::solveImpl(problem, strategy, strategies::DomainOrder(), options, stats, onSolution, prune);
+        } else {
+            result = util::solveImpl(problem, strategy, strategies::DomainOrder(), options, stats, onSolution);
+        }
+
+        for (std::size_t i = 0; i < bestValues.size(); ++i) {
+            problem.variables[i]->assign(bestValues[i]);
+        }
+
+        if (result != SolveResult::Aborted) {
+            result = best.has_value() ? SolveResult::Solved : SolveResult::Unsatisfiable;
         }
 
-        return util::recursiveSolve(problem, strategy);
+        return OptimizeResult<CostT>{result, std::move(best)};
+    }
+
+    /**
+     * Finds a solution of a CSP that minimizes an objective within the limits given by SolverOptions::limits (see
+     * csp::tryMinimize). Without a lower bound, only complete solutions are compared, so the whole search space is
+     * explored
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam Objective Type of the objective
+     * @tparam Strategy Type of value selection strategy during search
+     * @param problem CSP to be optimized
+     * @param objective cost of a solution
+     * @param strategy variable selection strategy
+     * @param options configuration of the solving algorithm including the limits of the search
+     * @return csp::OptimizeResult. The cost is optimal if the result is SolveResult::Solved
+     */
+    template<typename VarPtr, typename Objective, typename Strategy = strategies::Mrv<VarPtr>>
+    auto tryMinimize(Csp<VarPtr> &problem, const Objective &objective, const Strategy &strategy = Strategy(),
+                     const SolverOptions &options = {}) {
+        return tryMinimize(problem, objective, util::NoPruning(), strategy, options);
+    }
+
+    /**
+     * Finds a solution of a CSP that minimizes an objective using branch-and-bound (see csp::tryMinimize). If an
+     * optimal solution exists, the value domains of the variables are reduced to this solution
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam Objective Type of the objective. Is called with the fully assigned csp::Csp and returns a cost that is
+     * ordered by operator<
+     * @tparam LowerBound Type of the lower bound. Is called with the csp::Csp and returns the same cost type
+     * @tparam Strategy Type of value selection strategy during search
+     * @param problem CSP to be optimized
+     * @param objective cost of a solution
+     * @param lowerBound lower bound of the cost of all solutions in the current subtree. Must never overestimate.
+     * csp::util::NoPruning disables pruning
+     * @param strategy variable selection strategy
+     * @param options configuration of the solving algorithm
+     * @return cost of the optimal solution, std::nullopt if the problem has no solution or if one of the
+     * SolverOptions::limits was reached. Use csp::tryMinimize to obtain the best solution of an aborted search
+     */
+    template<typename VarPtr, typename Objective, typename LowerBound, typename Strategy>
+    auto minimize(Csp<VarPtr> &problem, const Objective &objective, const LowerBound &lowerBound,
+                  const Strategy &strategy, const SolverOptions &options = {}) {
+        auto [result, cost] = tryMinimize(problem, objective, lowerBound, strategy, options);
+        return result == SolveResult::Solved ? cost : std::nullopt;
+    }
+
+    /**
+     * Finds a solution of a CSP that minimizes an objective (see csp::minimize). Without a lower bound, only complete
+     * solutions are compared, so the whole search space is explored
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam Objective Type of the objective
+     * @tparam Strategy Type of value selection strategy during search
+     * @param problem CSP to be optimized
+     * @param objective cost of a solution
+     * @param strategy variable selection strategy
+     * @param options configuration of the solving algorithm
+     * @return cost of the optimal solution, std::nullopt if the problem has no solution or if one of the
+     * SolverOptions::limits was reached
+     */
+    template<typename VarPtr, typename Objective, typename Strategy = strategies::Mrv<VarPtr>>
+    auto minimize(Csp<VarPtr> &problem, const Objective &objective, const Strategy &strategy = Strategy(),
+                  const SolverOptions &options = {}) {
+        return minimize(problem, objective, util::NoPruning(), strategy, options);
     }
 }
 
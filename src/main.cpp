@@ -5,10 +5,17 @@
 #include <iomanip>
 #include <chrono>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
 
 #include "csp_solver.h"
 
-using VariableBase = csp::Variable<unsigned int, std::deque>;
+using VariableBase = csp::Variable<unsigned int, csp::Bitset<10>::Domain>;
 class SudokuNode : public  VariableBase {
 public:
     using Domain = VariableBase::DomainT;
@@ -45,6 +52,29 @@ public:
         }
     }
 
+    /**
+     * Reads a sudoku from a single line of 81 characters. Empty fields are given as '.' or '0'
+     * @param line row-major puzzle
+     */
+    explicit Sudoku(std::string_view line) {
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
+        if (line.size() != 81) {
+            throw std::runtime_error("Sudoku line must contain exactly 81 characters!");
+        }
+
+        for (std::size_t index = 0; index < line.size(); ++index) {
+            char c = line[index];
+            if (c != '.' && (c < '0' || c > '9')) {
+                throw std::runtime_error("Sudoku line contains invalid characters!");
+            }
+
+            fields[index] = std::make_shared<SudokuNode>(c == '.' ? 0 : static_cast<unsigned int>(c - '0'));
+        }
+    }
+
     static auto linearToCoordinates(unsigned int index) -> std::pair<unsigned int, unsigned int >{
         assert(index < 81);
         return {index % 9, index / 9};
@@ -96,68 +126,158 @@ public:
         out << std::endl;
     }
 
-    bool solve() {
-        std::vector<csp::Arc<std::shared_ptr<SudokuNode>>> arcs;
-        arcs.reserve(81 * 20);
+    /**
+     * Writes the sudoku as a single line of 81 characters. Unassigned fields are written as '.'
+     * @return row-major puzzle
+     */
+    [[nodiscard]] auto toLine() const -> std::string {
+        std::string ret(fields.size(), '.');
         for (std::size_t index = 0; index < fields.size(); ++index) {
-            auto neighbours = getNeighbours(index);
-            for (auto &nb : neighbours) {
-                arcs.emplace_back(fields[index], std::move(nb), std::not_equal_to<>());
+            if (auto val = fields[index]->getValue(); val.has_value()) {
+                ret[index] = static_cast<char>('0' + *val);
             }
         }
 
-        auto sudokuProblem = csp::make_csp(fields, arcs);
-        return csp::solve(sudokuProblem, csp::strategies::First<std::shared_ptr<SudokuNode>>());
+        return ret;
     }
 
-private:
-    [[nodiscard]] auto getNeighbours(unsigned int index) const -> std::array<std::shared_ptr<SudokuNode>, 20> {
-        auto [col, row] = linearToCoordinates(index);
-        std::array<std::shared_ptr<SudokuNode>, 20> ret;
-        auto it = ret.begin();
+    bool solve() {
+        // every row, column and block is one AllDifferent constraint
+        csp::ConstraintSet<std::shared_ptr<SudokuNode>> constraints;
         for (unsigned int i = 0; i < 9; ++i) {
-            if (i != col) {
-                *it = fields[coordinatesToLinear(i, row)];
-                ++it;
+            std::vector<std::shared_ptr<SudokuNode>> row, column, block;
+            for (unsigned int j = 0; j < 9; ++j) {
+                row.emplace_back(fields[coordinatesToLinear(j, i)]);
+                column.emplace_back(fields[coordinatesToLinear(i, j)]);
+                block.emplace_back(fields[coordinatesToLinear(3 * (i % 3) + j % 3, 3 * (i / 3) + j / 3)]);
             }
 
-            if (i != row) {
-                *it = fields[coordinatesToLinear(col, i)];
-                ++it;
-            }
+            constraints.add(csp::AllDifferent<std::shared_ptr<SudokuNode>>(std::move(row)));
+            constraints.add(csp::AllDifferent<std::shared_ptr<SudokuNode>>(std::move(column)));
+            constraints.add(csp::AllDifferent<std::shared_ptr<SudokuNode>>(std::move(block)));
         }
 
-        unsigned int blockNumber = 3 * (row / 3) + col / 3;
-        unsigned int colStart = (blockNumber % 3) * 3;
-        unsigned int rowStart = (blockNumber / 3) * 3;
-        for(unsigned int y = rowStart; y < rowStart + 3; y++){
-            for(unsigned int x = colStart; x < colStart + 3; x++){
-                if(x != col && y != row){
-                    *it = fields[coordinatesToLinear(x, y)];
-                    ++it;
+        auto sudokuProblem = csp::make_csp(fields, std::move(constraints));
+        return csp::solve(sudokuProblem, csp::strategies::First<std::shared_ptr<SudokuNode>>());
+    }
+
+private:
+    std::array<std::shared_ptr<SudokuNode>, 81> fields;
+};
+
+/**
+ * Solves a block of puzzles in parallel. Each worker parses, builds and solves the puzzles it takes from the block
+ * @param lines puzzles in line format
+ * @param numThreads number of worker threads
+ * @param results solution (or error message) of each puzzle, in the order of lines
+ * @return number of solved puzzles
+ */
+std::size_t solveBlock(const std::vector<std::string> &lines, unsigned int numThreads,
+                       std::vector<std::string> &results) {
+    constexpr std::size_t ChunkSize = 16;
+    results.assign(lines.size(), std::string());
+    std::atomic<std::size_t> next = 0;
+    std::atomic<std::size_t> solved = 0;
+    auto worker = [&lines, &results, &next, &solved]() {
+        std::size_t begin;
+        while ((begin = next.fetch_add(ChunkSize, std::memory_order_relaxed)) < lines.size()) {
+            const std::size_t end = std::min(begin + ChunkSize, lines.size());
+            for (std::size_t i = begin; i < end; ++i) {
+                try {
+                    Sudoku sudoku(lines[i]);
+                    if (sudoku.solve()) {
+                        results[i] = sudoku.toLine();
+                        solved.fetch_add(1, std::memory_order_relaxed);
+                    } else {
+                        results[i] = "unsolvable";
+                    }
+                } catch (const std::runtime_error &e) {
+                    results[i] = std::string("invalid: ") + e.what();
                 }
             }
         }
+    };
 
-        assert(it == ret.end());
-        return ret;
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for (unsigned int i = 1; i < numThreads; ++i) {
+        threads.emplace_back(worker);
     }
 
-    std::array<std::shared_ptr<SudokuNode>, 81> fields;
-};
+    worker();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    return solved;
+}
+
+/**
+ * Solves all puzzles in the input file (one puzzle per line) and writes the solutions to out in input order.
+ * The input is processed in blocks so that memory usage does not depend on the number of puzzles
+ * @param input puzzle file
+ * @param out solution output
+ * @param numThreads number of worker threads
+ */
+void solveBatch(std::istream &input, std::ostream &out, unsigned int numThreads) {
+    constexpr std::size_t BlockSize = 1 << 16;
+    std::vector<std::string> lines, results;
+    lines.reserve(BlockSize);
+    std::size_t total = 0, solved = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    std::string line;
+    while (input) {
+        lines.clear();
+        while (lines.size() < BlockSize && std::getline(input, line)) {
+            if (!line.empty() && line != "\r") {
+                lines.emplace_back(std::move(line));
+            }
+        }
+
+        solved += solveBlock(lines, numThreads, results);
+        total += lines.size();
+        for (const auto &result : results) {
+            out << result << '\n';
+        }
+    }
+
+    out.flush();
+    auto stop = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    std::cerr << "Solved " << solved << " of " << total << " sudokus in " << std::fixed << std::setprecision(3)
+              << seconds << "s using " << numThreads << " threads (" << std::setprecision(0)
+              << (seconds > 0 ? static_cast<double>(total) / seconds : 0.0) << " puzzles/s)" << std::endl;
+}
 
 int main(int argc, char **argv) {
-    if (argc != 2) {
-        std::cerr << "Please input the path to the sudoku file" << std::endl;
+    std::vector<std::string_view> args(argv + 1, argv + argc);
+    const bool batch = !args.empty() && args.front() == "--batch";
+    unsigned int numThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (batch) {
+        args.erase(args.begin());
+        if (args.size() == 3 && args[1] == "--threads") {
+            numThreads = static_cast<unsigned int>(std::max(1, std::atoi(args[2].data())));
+            args.resize(1);
+        }
+    }
+
+    if (args.size() != 1) {
+        std::cerr << "Usage: " << argv[0] << " <sudoku file>" << std::endl
+                  << "       " << argv[0] << " --batch <puzzle file> [--threads <n>]" << std::endl;
         std::exit(1);
     }
 
-    std::ifstream sudokuFile(argv[1]);
+    std::ifstream sudokuFile(args.front().data());
     if (!sudokuFile) {
-        std::cerr << "Failed to open file '" << argv[1] << "'" << std::endl;
+        std::cerr << "Failed to open file '" << args.front() << "'" << std::endl;
         std::exit(1);
     }
 
+    if (batch) {
+        solveBatch(sudokuFile, std::cout, numThreads);
+        return 0;
+    }
+
     Sudoku sudoku(sudokuFile);
     sudoku.print(std::cout);
 
@@ -0,0 +1,277 @@
+/**
+ * @file revise.h
+ * @author Tim Luchterhand
+ * @date 18.10.26
+ * @brief This file contains the revision of single arcs, the basic operation of all arc consistency algorithms.
+ * Revisions are implemented once for arbitrary predicates. csp::util::ArcReviser binds the revision to the concrete
+ * predicate type of a constraint, so that a csp::Csp can store constraints of different predicate types without
+ * evaluating them through std::function.
+ */
+
+#ifndef CSP_SOLVER_REVISE_H
+#define CSP_SOLVER_REVISE_H
+
+#include <memory>
+#include <type_traits>
+
+#include "Arc.h"
+#include "BitsetDomain.h"
+#include "Trail.h"
+
+namespace csp::util {
+
+    /**
+     * Removes all values from the domain of from that have no support in the domain of to.
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam Save Callable type
+     * @tparam Satisfied Binary predicate type
+     * @param from source variable of the arc
+     * @param to destination variable of the arc
+     * @param save called once before the domain of from is modified, e.g. to save it to the trail
+     * @param satisfied Called with values of (from, to). Returns true if the pair is allowed
+     * @return True if the value domain of from was modified, false otherwise
+     */
+    template<typename VarPtr, typename Save, typename Satisfied>
+    bool removeUnsupported(const VarPtr &from, const VarPtr &to, Save &&save, const Satisfied &satisfied) {
+        using Domain = typename std::remove_reference_t<decltype(*from)>::DomainT;
+        auto &fromDomain = from->valueDomain();
+        const Domain &toDomain = to->valueDomain();
+        if constexpr (type_traits::is_bitset_domain<Domain>::value) {
+            // The predicate is still evaluated for each pair of values until a support is found. Only the removal is
+            // done word by word by intersecting the source domain with the supported values. Word by word support
+            // checks require a csp::SupportMatrix (see csp::util::removeInconsistent for csp::Csp)
+            Domain supported;
+            for (auto valFrom : fromDomain) {
+                for (auto valTo : toDomain) {
+                    if (satisfied(valFrom, valTo)) {
+                        supported.insert(valFrom);
+                        break;
+                    }
+                }
+            }
+
+            if (supported == fromDomain) {
+                return false;
+            }
+
+            save();
+            return fromDomain.intersect(supported);
+        } else {
+            bool removed = false;
+            for (auto it = fromDomain.begin(); it != fromDomain.end();) {
+                bool consistent = false;
+                for (const auto &val : toDomain) {
+                    if (satisfied(*it, val)) {
+                        consistent = true;
+                        break;
+                    }
+                }
+
+                if (!consistent) {
+                    if (!removed) {
+                        // iterator stays valid, saving only copies the domain
+                        save();
+                    }
+
+                    it = fromDomain.erase(it);
+                    removed = true;
+                } else {
+                    ++it;
+                }
+            }
+
+            return removed;
+        }
+    }
+
+    /**
+     * Removes all inconsistent values from the source node of the given csp::Arc. As a result, the source node's
+     * value domain only contains values for which a valid value in the domain of the destination node exists.
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam Predicate Type of the constraint predicate
+     * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+     * @param arc Arc to be processed
+     * @param trail The source node's value domain is saved to the trail before it is modified
+     * @return True if the value domain of the source node was modified, false otherwise
+     */
+    template<typename VarPtr, typename Predicate, typename TrailT>
+    bool removeInconsistent(const Arc<VarPtr, Predicate> &arc, TrailT &trail) {
+        return removeUnsupported(arc.from(), arc.to(), [&arc, &trail]() { trail.save(arc.from()); },
+                                 [&arc](const auto &valFrom, const auto &valTo) {
+                                     return arc.constraintSatisfied(valFrom, valTo);
+                                 });
+    }
+
+    /**
+     * Removes all inconsistent values from the source node of the given csp::Arc. As a result, the source node's
+     * value domain only contains values for which a valid value in the domain of the destination node exists.
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam Predicate Type of the constraint predicate
+     * @param arc Arc to be processed
+     * @return True if the value domain of the source node was modified, false otherwise
+     */
+    template<typename VarPtr, typename Predicate>
+    bool removeInconsistent(const Arc<VarPtr, Predicate> &arc) {
+        NoTrail trail;
+        return removeInconsistent(arc, trail);
+    }
+
+    /**
+     * Revision function of an arc stored in a csp::Csp. Holds the constraint predicate with its concrete type and
+     * pointers to removeInconsistent, the support search and the predicate check instantiated for this type. Calling
+     * the reviser costs one indirect call per revision instead of one std::function call per checked value pair.
+     * AC-3rm searches supports of single values using findSupport(), other algorithms that check single pairs of
+     * values (e.g. the compilation of csp::SupportMatrix) use satisfied()
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     */
+    template<typename VarPtr>
+    class ArcReviser {
+    public:
+        using ArcT = Arc<VarPtr>;
+        using ValueT = typename ArcT::VarType;
+        using ReviseFn = bool (*)(const ArcT &, std::size_t, const void *, Trail<VarPtr> *);
+        using SupportFn = bool (*)(const ArcT &, const void *, const ValueT &, ValueT &);
+        using SatisfiedFn = bool (*)(const ArcT &, const void *, const ValueT &, const ValueT &);
+
+        /**
+         * Creates a reviser that evaluates the predicate stored in the (type-erased) arc
+         * @return csp::util::ArcReviser
+         */
+        static auto erased() -> ArcReviser {
+            return ArcReviser(&reviseErased, &findSupportErased, &satisfiedErased, nullptr);
+        }
+
+        /**
+         * Creates a reviser for a predicate of known type
+         * @tparam Predicate Type of the predicate
+         * @param predicate the constraint predicate. Can be shared by an arc and its reverse
+         * @return csp::util::ArcReviser
+         */
+        template<typename Predicate>
+        static auto typed(std::shared_ptr<const Predicate> predicate) -> ArcReviser {
+            return ArcReviser(&reviseTyped<Predicate>, &findSupportTyped<Predicate>, &satisfiedTyped<Predicate>,
+                              std::move(predicate));
+        }
+
+        /**
+         * Revises the given arc (see csp::util::removeInconsistent)
+         * @param arc the arc this reviser was created for
+         * @param fromId index of the source variable of arc in the csp::Csp
+         * @param trail undo log, may be nullptr
+         * @return True if the value domain of the source node was modified, false otherwise
+         */
+        bool operator()(const ArcT &arc, std::size_t fromId, Trail<VarPtr> *trail) const {
+            return revise(arc, fromId, predicate.get(), trail);
+        }
+
+        /**
+         * Searches the value domain of the destination variable for a value that supports the given value
+         * @param arc the arc this reviser was created for
+         * @param valFrom value of the source variable
+         * @param support set to the first supporting value of the destination variable, if any
+         * @return True if a supporting value was found
+         */
+        bool findSupport(const ArcT &arc, const ValueT &valFrom, ValueT &support) const {
+            return supportFn(arc, predicate.get(), valFrom, support);
+        }
+
+        /**
+         * Checks a single pair of values using the concrete predicate type
+         * @param arc the arc this reviser was created for
+         * @param valFrom value of the source variable
+         * @param valTo value of the destination variable
+         * @return True if the pair of values satisfies the constraint
+         */
+        bool satisfied(const ArcT &arc, const ValueT &valFrom, const ValueT &valTo) const {
+            return satisfiedFn(arc, predicate.get(), valFrom, valTo);
+        }
+
+    private:
+        ArcReviser(ReviseFn revise, SupportFn supportFn, SatisfiedFn satisfiedFn,
+                   std::shared_ptr<const void> predicate) :
+                revise(revise), supportFn(supportFn), satisfiedFn(satisfiedFn), predicate(std::move(predicate)) {}
+
+        template<typename Satisfied>
+        static bool reviseWith(const ArcT &arc, std::size_t fromId, Trail<VarPtr> *trail,
+                               const Satisfied &satisfied) {
+            return removeUnsupported(arc.from(), arc.to(), [&arc, fromId, trail]() {
+                if (trail != nullptr) {
+                    trail->save(fromId, arc.from());
+                }
+            }, satisfied);
+        }
+
+        static bool reviseErased(const ArcT &arc, std::size_t fromId, const void *, Trail<VarPtr> *trail) {
+            return reviseWith(arc, fromId, trail, [&arc](const auto &valFrom, const auto &valTo) {
+                return arc.constraintSatisfied(valFrom, valTo);
+            });
+        }
+
+        template<typename Predicate>
+        static bool reviseTyped(const ArcT &arc, std::size_t fromId, const void *predicate, Trail<VarPtr> *trail) {
+            const Predicate &pred = *static_cast<const Predicate *>(predicate);
+            // direction is resolved once per revision instead of once per value pair
+            if (arc.isReversed()) {
+                return reviseWith(arc, fromId, trail, [&pred](const auto &valFrom, const auto &valTo) {
+                    return pred(valTo, valFrom);
+                });
+            }
+
+            return reviseWith(arc, fromId, trail, [&pred](const auto &valFrom, const auto &valTo) {
+                return pred(valFrom, valTo);
+            });
+        }
+
+        template<typename Satisfied>
+        static bool findSupportWith(const ArcT &arc, const ValueT &valFrom, ValueT &support,
+                                    const Satisfied &satisfied) {
+            for (const auto &valTo : arc.to()->valueDomain()) {
+                if (satisfied(valFrom, valTo)) {
+                    support = valTo;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        static bool findSupportErased(const ArcT &arc, const void *, const ValueT &valFrom, ValueT &support) {
+            return findSupportWith(arc, valFrom, support, [&arc](const ValueT &a, const ValueT &b) {
+                return arc.constraintSatisfied(a, b);
+            });
+        }
+
+        template<typename Predicate>
+        static bool findSupportTyped(const ArcT &arc, const void *predicate, const ValueT &valFrom,
+                                     ValueT &support) {
+            const Predicate &pred = *static_cast<const Predicate *>(predicate);
+            if (arc.isReversed()) {
+                return findSupportWith(arc, valFrom, support, [&pred](const ValueT &a, const ValueT &b) {
+                    return pred(b, a);
+                });
+            }
+
+            return findSupportWith(arc, valFrom, support, [&pred](const ValueT &a, const ValueT &b) {
+                return pred(a, b);
+            });
+        }
+
+        static bool satisfiedErased(const ArcT &arc, const void *, const ValueT &valFrom, const ValueT &valTo) {
+            return arc.constraintSatisfied(valFrom, valTo);
+        }
+
+        template<typename Predicate>
+        static bool satisfiedTyped(const ArcT &arc, const void *predicate, const ValueT &valFrom,
+                                   const ValueT &valTo) {
+            const Predicate &pred = *static_cast<const Predicate *>(predicate);
+            return arc.isReversed() ? pred(valTo, valFrom) : pred(valFrom, valTo);
+        }
+
+        ReviseFn revise;
+        SupportFn supportFn;
+        SatisfiedFn satisfiedFn;
+        std::shared_ptr<const void> predicate;
+    };
+}
+
+#endif //CSP_SOLVER_REVISE_H
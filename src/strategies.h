@@ -4,17 +4,85 @@
  * @date 25.07.20
  * @brief This file contains different variable choosing strategies that can be used to solve a CSP. Apart from these
  * strategies, custom strategies can be used. A strategy must return one of the pointers to a variable stored in the
- * given CSP.
+ * given CSP. Stateful strategies additionally provide init() and onDomainChanged() and are informed by the solver about
+ * each change of a value domain during search (see csp::type_traits::is_stateful_strategy). Conflict aware strategies
+ * are also informed about each arc whose revision wiped out a value domain (see
+ * csp::type_traits::is_conflict_aware_strategy). Value orders decide in which order the values of the chosen variable
+ * are tried (see csp::type_traits::is_value_order).
  */
 
 #ifndef CSP_SOLVER_STRATEGIES_H
 #define CSP_SOLVER_STRATEGIES_H
 
 #include <algorithm>
+#include <vector>
+#include <limits>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <random>
+#include <cstdint>
 
 #include "Csp.h"
 #include "Variable.h"
 
+namespace csp::type_traits {
+    namespace implementations {
+        template<typename Strategy, typename Problem>
+        auto statefulTest(int) -> decltype(std::declval<Strategy &>().init(std::declval<const Problem &>()),
+                std::declval<Strategy &>().onDomainChanged(std::declval<const Problem &>(), std::size_t()),
+                std::true_type());
+
+        template<typename Strategy, typename Problem>
+        std::false_type statefulTest(...);
+
+        template<typename Strategy, typename Problem>
+        auto conflictTest(int) -> decltype(std::declval<Strategy &>().onConflict(std::declval<const Problem &>(),
+                std::size_t()), std::true_type());
+
+        template<typename Strategy, typename Problem>
+        std::false_type conflictTest(...);
+
+        template<typename Order, typename Problem>
+        auto valueOrderTest(int) -> decltype(std::declval<const Order &>()(std::declval<const Problem &>(),
+                std::size_t(), std::declval<std::vector<typename Problem::VarT::ValueT> &>()), std::true_type());
+
+        template<typename Order, typename Problem>
+        std::false_type valueOrderTest(...);
+    }
+
+    /**
+     * Used to check if a strategy needs to be informed about domain changes. Stateful strategies provide
+     * init(const Csp &), which is called after the initial propagation, and onDomainChanged(const Csp &, varId), which
+     * is called whenever the value domain of a variable was reduced or restored. The solver uses a copy of a stateful
+     * strategy for each search
+     * @tparam Strategy Type of the strategy
+     * @tparam Problem csp::Csp type
+     */
+    template<typename Strategy, typename Problem>
+    struct is_stateful_strategy : decltype(implementations::statefulTest<Strategy, Problem>(0)) {};
+
+    /**
+     * Used to check if a stateful strategy needs to be informed about conflicts. Conflict aware strategies provide
+     * onConflict(const Csp &, arcId) which is called whenever propagation after an assignment failed. arcId is the
+     * index of the arc whose revision emptied a value domain
+     * @tparam Strategy Type of the strategy
+     * @tparam Problem csp::Csp type
+     */
+    template<typename Strategy, typename Problem>
+    struct is_conflict_aware_strategy : decltype(implementations::conflictTest<Strategy, Problem>(0)) {};
+
+    /**
+     * Used to check if a type can be used as value order during search. A value order is called with the problem, the
+     * index of the chosen variable and a std::vector containing the values of its domain. It reorders the vector in
+     * place. The values are then tried in the order of the vector
+     * @tparam Order Type of the value order
+     * @tparam Problem csp::Csp type
+     */
+    template<typename Order, typename Problem>
+    struct is_value_order : decltype(implementations::valueOrderTest<Order, Problem>(0)) {};
+}
+
 
 /**
  * @brief contains different variable choosing strategies that can be used to solve a CSP. Apart from these
@@ -29,7 +97,21 @@ namespace csp::strategies {
      */
     template<typename VarPtr>
     struct Mrv {
+        Mrv() = default;
+
+        /**
+         * Ctor. Ties between variables with the fewest remaining values are broken randomly. Combined with restarts
+         * (see csp::SolverOptions::restarts), each restart explores a different part of the search space
+         * @param seed seed of the random number generator
+         * @note the generator is advanced by each call, also if the strategy is passed as const reference
+         */
+        explicit Mrv(std::uint64_t seed) : randomized(true), rng(static_cast<std::minstd_rand::result_type>(seed)) {}
+
         VarPtr operator() (const Csp<VarPtr> &problem) const {
+            if (randomized) {
+                return randomTieBreak(problem);
+            }
+
             auto it = std::min_element(problem.variables.begin(), problem.variables.end(),
                     [](const auto &lhs, const auto &rhs) {
                 return rhs->isAssigned() || (!lhs->isAssigned() &&
@@ -39,6 +121,444 @@ namespace csp::strategies {
             assert(it != problem.variables.end());
             return *it;
         }
+
+    private:
+        // reservoir sampling over all unassigned variables with the fewest remaining values
+        VarPtr randomTieBreak(const Csp<VarPtr> &problem) const {
+            assert(!problem.variables.empty());
+            const VarPtr *best = &problem.variables.front();
+            std::size_t bestSize = std::numeric_limits<std::size_t>::max();
+            std::size_t ties = 0;
+            for (const auto &var : problem.variables) {
+                if (var->isAssigned()) {
+                    continue;
+                }
+
+                const std::size_t size = std::size(var->valueDomain());
+                if (size < bestSize) {
+                    bestSize = size;
+                    best = &var;
+                    ties = 1;
+                } else if (size == bestSize && rng() % ++ties == 0) {
+                    best = &var;
+                }
+            }
+
+            return *best;
+        }
+
+        bool randomized = false;
+        mutable std::minstd_rand rng;
+    };
+
+    /**
+     * Minimum remaining values strategy that keeps the unassigned variables in buckets indexed by their domain size.
+     * The buckets are updated incrementally whenever the solver reduces or restores a value domain, so that selecting
+     * a variable does not require a scan over all variables
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @note If multiple variables have the fewest remaining values, it is unspecified which of them is chosen
+     */
+    template<typename VarPtr>
+    class IncrementalMrv {
+    public:
+        IncrementalMrv() = default;
+
+        /**
+         * Ctor. Initializes the buckets from the current value domains
+         * @param problem CSP the strategy is used for
+         */
+        explicit IncrementalMrv(const Csp<VarPtr> &problem) {
+            init(problem);
+        }
+
+        /**
+         * Sorts all variables into buckets according to their current domain size
+         * @param problem CSP the strategy is used for
+         */
+        void init(const Csp<VarPtr> &problem) {
+            buckets.clear();
+            bucketSize.assign(problem.variables.size(), NoBucket);
+            positions.assign(problem.variables.size(), 0);
+            for (std::size_t i = 0; i < problem.variables.size(); ++i) {
+                onDomainChanged(problem, i);
+            }
+        }
+
+        /**
+         * Moves a variable to the bucket of its current domain size. Assigned variables are not kept in any bucket
+         * @param problem CSP the strategy is used for
+         * @param varId index of the changed variable
+         */
+        void onDomainChanged(const Csp<VarPtr> &problem, std::size_t varId) {
+            const std::size_t size = std::size(problem.variables[varId]->valueDomain());
+            const std::size_t bucket = size > 1 ? size : NoBucket;
+            if (bucket == bucketSize[varId]) {
+                return;
+            }
+
+            remove(varId);
+            if (bucket != NoBucket) {
+                insert(varId, bucket);
+            }
+        }
+
+        VarPtr operator()(const Csp<VarPtr> &problem) const {
+            assert(!problem.variables.empty());
+            for (const auto &bucket : buckets) {
+                if (!bucket.empty()) {
+                    return problem.variables[bucket.back()];
+                }
+            }
+
+            // all variables are assigned
+            return problem.variables.front();
+        }
+
+    private:
+        static constexpr std::size_t NoBucket = std::numeric_limits<std::size_t>::max();
+        // bucket i contains the variables with domain size i + 2
+        static constexpr std::size_t MinSize = 2;
+
+        void insert(std::size_t varId, std::size_t size) {
+            const std::size_t bucket = size - MinSize;
+            if (bucket >= buckets.size()) {
+                buckets.resize(bucket + 1);
+            }
+
+            bucketSize[varId] = size;
+            positions[varId] = buckets[bucket].size();
+            buckets[bucket].emplace_back(varId);
+        }
+
+        void remove(std::size_t varId) {
+            if (bucketSize[varId] == NoBucket) {
+                return;
+            }
+
+            auto &bucket = buckets[bucketSize[varId] - MinSize];
+            const std::size_t last = bucket.back();
+            bucket[positions[varId]] = last;
+            positions[last] = positions[varId];
+            bucket.pop_back();
+            bucketSize[varId] = NoBucket;
+        }
+
+        std::vector<std::vector<std::size_t>> buckets;
+        std::vector<std::size_t> bucketSize;
+        std::vector<std::size_t> positions;
+    };
+
+    namespace implementations {
+        /**
+         * Checks if a global constraint contains an unassigned variable other than the given one
+         */
+        template<typename VarPtr>
+        bool hasOtherUnassigned(const Csp<VarPtr> &problem, std::size_t constraint, std::size_t varId) {
+            auto scope = problem.scope(constraint);
+            return std::any_of(scope.begin(), scope.end(), [&problem, varId](std::size_t other) {
+                return other != varId && !problem.variables[other]->isAssigned();
+            });
+        }
+    }
+
+    /**
+     * Maximum degree strategy. Chooses the unassigned variable that is involved in the most constraints (static
+     * degree). Ties are broken by the number of remaining values
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     */
+    template<typename VarPtr>
+    struct MaxDegree {
+        VarPtr operator()(const Csp<VarPtr> &problem) const {
+            assert(!problem.variables.empty());
+            std::size_t best = problem.variables.size();
+            for (std::size_t i = 0; i < problem.variables.size(); ++i) {
+                const auto &var = problem.variables[i];
+                if (var->isAssigned()) {
+                    continue;
+                }
+
+                if (best == problem.variables.size()) {
+                    best = i;
+                    continue;
+                }
+
+                const std::size_t degree = problem.incomingArcs(i).size() + problem.globalsOf(i).size();
+                const std::size_t bestDegree = problem.incomingArcs(best).size() + problem.globalsOf(best).size();
+                if (degree > bestDegree || (degree == bestDegree &&
+                    var->valueDomain().size() < problem.variables[best]->valueDomain().size())) {
+                    best = i;
+                }
+            }
+
+            return best == problem.variables.size() ? problem.variables.front() : problem.variables[best];
+        }
+    };
+
+    /**
+     * Minimum remaining values strategy with ties broken by the dynamic degree, i.e. the number of constraints with
+     * other unassigned variables
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     */
+    template<typename VarPtr>
+    struct MrvDegree {
+        VarPtr operator()(const Csp<VarPtr> &problem) const {
+            assert(!problem.variables.empty());
+            std::size_t best = problem.variables.size();
+            std::size_t bestSize = 0;
+            std::size_t bestDegree = 0;
+            for (std::size_t i = 0; i < problem.variables.size(); ++i) {
+                const auto &var = problem.variables[i];
+                if (var->isAssigned()) {
+                    continue;
+                }
+
+                const std::size_t size = std::size(var->valueDomain());
+                if (best != problem.variables.size() && size > bestSize) {
+                    continue;
+                }
+
+                const std::size_t degree = dynamicDegree(problem, i);
+                if (best == problem.variables.size() || size < bestSize || degree > bestDegree) {
+                    best = i;
+                    bestSize = size;
+                    bestDegree = degree;
+                }
+            }
+
+            return best == problem.variables.size() ? problem.variables.front() : problem.variables[best];
+        }
+
+    private:
+        static std::size_t dynamicDegree(const Csp<VarPtr> &problem, std::size_t varId) {
+            auto arcs = problem.incomingArcs(varId);
+            auto globals = problem.globalsOf(varId);
+            return static_cast<std::size_t>(std::count_if(arcs.begin(), arcs.end(), [&problem](std::size_t arc) {
+                return !problem.variables[problem.arcSources[arc]]->isAssigned();
+            }) + std::count_if(globals.begin(), globals.end(), [&problem, varId](std::size_t constraint) {
+                return implementations::hasOtherUnassigned(problem, constraint, varId);
+            }));
+        }
+    };
+
+    /**
+     * Conflict driven dom/wdeg strategy. Each constraint has a weight that is initially 1 and that is increased
+     * whenever the constraint wipes out a value domain during search. Chooses the unassigned variable with the smallest
+     * ratio of remaining values and weighted degree, where only constraints with other unassigned variables count
+     * towards the weighted degree. The weights are kept for the whole search so that the strategy focuses on the hard
+     * parts of the problem. Global constraints have weights as well
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     */
+    template<typename VarPtr>
+    class DomWdeg {
+    public:
+        DomWdeg() = default;
+
+        /**
+         * Ctor. Initializes all constraint weights to 1
+         * @param problem CSP the strategy is used for
+         */
+        explicit DomWdeg(const Csp<VarPtr> &problem) {
+            init(problem);
+        }
+
+        /**
+         * Initializes all constraint weights to 1
+         * @param problem CSP the strategy is used for
+         */
+        void init(const Csp<VarPtr> &problem) {
+            weights.assign(problem.queueSize(), 1);
+        }
+
+        /**
+         * Weights only depend on conflicts, nothing to do here
+         */
+        void onDomainChanged(const Csp<VarPtr> &, std::size_t) noexcept {}
+
+        /**
+         * Increases the weight of the constraint the given arc belongs to, i.e. of the arc and its reverse arc (see
+         * csp::Csp::reverseArcs)
+         * @param problem CSP the strategy is used for
+         * @param arcId queue index of the arc whose revision wiped out a value domain or of the failed global
+         * constraint
+         */
+        void onConflict(const Csp<VarPtr> &problem, std::size_t arcId) {
+            assert(arcId < weights.size());
+            ++weights[arcId];
+            if (arcId < problem.arcs.size() && problem.reverseArcs[arcId] != Csp<VarPtr>::NoArc) {
+                ++weights[problem.reverseArcs[arcId]];
+            }
+        }
+
+        /**
+         * Current weight of an arc
+         * @param arcId queue index of the arc or global constraint
+         * @return number of conflicts caused by the constraint of the arc plus one
+         */
+        [[nodiscard]] std::size_t weight(std::size_t arcId) const {
+            return weights.at(arcId);
+        }
+
+        VarPtr operator()(const Csp<VarPtr> &problem) const {
+            assert(!problem.variables.empty());
+            assert(weights.size() == problem.queueSize());
+            std::size_t best = problem.variables.size();
+            double bestScore = 0;
+            for (std::size_t i = 0; i < problem.variables.size(); ++i) {
+                const auto &var = problem.variables[i];
+                if (var->isAssigned()) {
+                    continue;
+                }
+
+                std::size_t wdeg = 0;
+                for (std::size_t arc : problem.incomingArcs(i)) {
+                    if (!problem.variables[problem.arcSources[arc]]->isAssigned()) {
+                        wdeg += weights[arc];
+                    }
+                }
+
+                for (std::size_t constraint : problem.globalsOf(i)) {
+                    if (implementations::hasOtherUnassigned(problem, constraint, i)) {
+                        wdeg += weights[problem.arcs.size() + constraint];
+                    }
+                }
+
+                const double score = static_cast<double>(std::size(var->valueDomain())) /
+                                     static_cast<double>(std::max(wdeg, std::size_t(1)));
+                if (best == problem.variables.size() || score < bestScore) {
+                    best = i;
+                    bestScore = score;
+                }
+            }
+
+            return best == problem.variables.size() ? problem.variables.front() : problem.variables[best];
+        }
+
+    private:
+        std::vector<std::size_t> weights;
+    };
+
+    /**
+     * Value order that tries the values in the order of the value domain. This is the default of csp::solve and does
+     * not copy the domain into a std::vector
+     */
+    struct DomainOrder {
+        template<typename Problem, typename Values>
+        constexpr void operator()(const Problem &, std::size_t, Values &) const noexcept {}
+    };
+
+    /**
+     * Value order that sorts the values using a custom comparator. Values that are equivalent with respect to the
+     * comparator are tried in domain order
+     * @tparam Compare Binary predicate type. Returns true if the first value should be tried before the second one
+     */
+    template<typename Compare>
+    class ValueComparator {
+    public:
+        /**
+         * Ctor
+         * @param compare comparator object
+         */
+        explicit ValueComparator(Compare compare) : compare(std::move(compare)) {}
+
+        template<typename Problem, typename ValueT>
+        void operator()(const Problem &, std::size_t, std::vector<ValueT> &values) const {
+            std::stable_sort(values.begin(), values.end(), compare);
+        }
+
+    private:
+        Compare compare;
+    };
+
+    /**
+     * Least constraining value order. Tries the values first that remove the fewest values from the domains of
+     * unassigned neighbours. If the constraints were compiled using csp::ConstraintMode::Matrix, the support matrices
+     * are used instead of the constraint predicates. Only binary constraints are taken into account
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     */
+    template<typename VarPtr>
+    struct LeastConstrainingValue {
+        using ValueT = typename Csp<VarPtr>::VarT::ValueT;
+
+        void operator()(const Csp<VarPtr> &problem, std::size_t varId, std::vector<ValueT> &values) const {
+            std::vector<std::pair<std::size_t, ValueT>> ranked;
+            ranked.reserve(values.size());
+            for (const auto &val : values) {
+                ranked.emplace_back(0, val);
+            }
+
+            for (std::size_t arc : problem.incomingArcs(varId)) {
+                if (problem.arcs[arc].from()->isAssigned()) {
+                    continue;
+                }
+
+                for (auto &[removed, val] : ranked) {
+                    removed += conflicts(problem, arc, val);
+                }
+            }
+
+            std::stable_sort(ranked.begin(), ranked.end(), [](const auto &lhs, const auto &rhs) {
+                return lhs.first < rhs.first;
+            });
+
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                values[i] = std::move(ranked[i].second);
+            }
+        }
+
+    private:
+        /**
+         * Counts the values of the source domain that do not support the given value of the target variable
+         */
+        static std::size_t conflicts(const Csp<VarPtr> &problem, std::size_t arcId, const ValueT &val) {
+            const auto &arc = problem.arcs[arcId];
+            const auto &reviser = problem.arcRevisers[arcId];
+            std::size_t ret = 0;
+            if constexpr (std::is_integral_v<ValueT>) {
+                if (!problem.arcSupports.empty()) {
+                    // the reverse direction of the matrix maps values of the target to allowed source values
+                    const ArcSupport &support = problem.arcSupports[arcId];
+                    const auto &matrix = problem.supportMatrices[support.matrix];
+                    const auto *row = matrix.sourceCompiled(val, !support.transposed) ?
+                                      matrix.row(val, !support.transposed) : nullptr;
+                    for (const auto &other : arc.from()->valueDomain()) {
+                        const bool supported = row != nullptr && matrix.targetCompiled(other, !support.transposed) ?
+                                               matrix.test(row, other, !support.transposed) :
+                                               reviser.satisfied(arc, other, val);
+                        ret += !supported;
+                    }
+
+                    return ret;
+                }
+            }
+
+            for (const auto &other : arc.from()->valueDomain()) {
+                ret += !reviser.satisfied(arc, other, val);
+            }
+
+            return ret;
+        }
+    };
+
+    /**
+     * Value order that tries the values in random order. Combined with restarts (see csp::SolverOptions::restarts),
+     * each restart explores a different part of the search space
+     * @note the generator is advanced by each call, also if the value order is passed as const reference
+     */
+    class RandomValueOrder {
+    public:
+        /**
+         * Ctor
+         * @param seed seed of the random number generator
+         */
+        explicit RandomValueOrder(std::uint64_t seed) : rng(static_cast<std::minstd_rand::result_type>(seed)) {}
+
+        template<typename Problem, typename ValueT>
+        void operator()(const Problem &, std::size_t, std::vector<ValueT> &values) const {
+            std::shuffle(values.begin(), values.end(), rng);
+        }
+
+    private:
+        mutable std::minstd_rand rng;
     };
 
     /**
@@ -8,46 +8,364 @@
 #ifndef CSP_SOLVER_UTIL_H
 #define CSP_SOLVER_UTIL_H
 #include <vector>
+#include <algorithm>
+#include <type_traits>
 
 #include "Variable.h"
 #include "Arc.h"
 #include "Csp.h"
+#include "BitsetDomain.h"
+#include "Trail.h"
+#include "ArcQueue.h"
+#include "revise.h"
+#include "SolveStats.h"
 
 /**
  * @brief contains utility functions used by the search algorithm
  */
 namespace csp::util {
 
+    namespace implementations {
+        template<typename Container, typename T>
+        auto containsImpl(const Container &c, const T &val, int) -> decltype(c.contains(val)) {
+            return c.contains(val);
+        }
+
+        template<typename Container, typename T>
+        auto containsImpl(const Container &c, const T &val, long) -> decltype(c.find(val) != c.end()) {
+            return c.find(val) != c.end();
+        }
+
+        template<typename Container, typename T>
+        bool containsImpl(const Container &c, const T &val, ...) {
+            return std::find(std::begin(c), std::end(c), val) != std::end(c);
+        }
+    }
+
     /**
-     * Removes all inconsistent values from the source node of the given csp::Arc. As a result, the source node's
-     * value domain only contains values for which a valid value in the domain of the destination node exists.
-     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
-     * @param arc Arc to be processed
+     * Checks whether a value domain contains the given value. Uses the container's own lookup if available
+     * (e.g. csp::BitsetDomain::contains or std::set::find), linear search otherwise
+     * @tparam Container Domain container type
+     * @tparam T value type
+     * @param domain value domain
+     * @param val value to look for
+     * @return true if val is contained in domain
+     */
+    template<typename Container, typename T>
+    bool contains(const Container &domain, const T &val) {
+        return implementations::containsImpl(domain, val, 0);
+    }
+
+    /**
+     * Removes all inconsistent values from the source node of an arc using the arc's csp::SupportMatrix instead of
+     * the constraint predicate. For csp::BitsetDomain variables, a value is supported if its matrix row intersects
+     * the destination domain, which is checked word by word.
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable with integral values
+     * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+     * @param problem CSP created with csp::ConstraintMode::Matrix
+     * @param arcId index of the arc to be processed
+     * @param trail The source node's value domain is saved to the trail before it is modified
      * @return True if the value domain of the source node was modified, false otherwise
      */
+    template<typename VarPtr, typename TrailT>
+    bool removeInconsistent(const Csp<VarPtr> &problem, std::size_t arcId, TrailT &trail) {
+        using Domain = typename Csp<VarPtr>::VarT::DomainT;
+        const auto &arc = problem.arcs[arcId];
+        const auto &reviser = problem.arcRevisers[arcId];
+        const ArcSupport &support = problem.arcSupports[arcId];
+        const auto &matrix = problem.supportMatrices[support.matrix];
+        auto &fromDomain = arc.from()->valueDomain();
+        const Domain &toDomain = arc.to()->valueDomain();
+        if constexpr (type_traits::is_bitset_domain<Domain>::value) {
+            // values that were not part of the domains when the matrix was created are checked using the predicate
+            auto predicateSupport = [&arc, &reviser, &matrix, &support, &toDomain](const auto &valFrom,
+                                                                                   bool onlyUncompiled) {
+                for (const auto &valTo : toDomain) {
+                    if ((!onlyUncompiled || !matrix.targetCompiled(valTo, support.transposed)) &&
+                        reviser.satisfied(arc, valFrom, valTo)) {
+                        return true;
+                    }
+                }
+
+                return false;
+            };
+
+            // matrix universes are the whole bitset universe, so rows exist for all values and have domain layout
+            const bool uncompiledTargets = toDomain.intersects(matrix.uncompiledTargets(support.transposed));
+            Domain supported;
+            for (auto val : fromDomain) {
+                const bool consistent = matrix.sourceCompiled(val, support.transposed) ?
+                        toDomain.intersects(matrix.row(val, support.transposed)) ||
+                        (uncompiledTargets && predicateSupport(val, true)) : predicateSupport(val, false);
+                if (consistent) {
+                    supported.insert(val);
+                }
+            }
+
+            if (supported == fromDomain) {
+                return false;
+            }
+
+            trail.save(problem.arcSources[arcId], arc.from());
+            return fromDomain.intersect(supported);
+        } else {
+            bool removed = false;
+            for (auto it = fromDomain.begin(); it != fromDomain.end();) {
+                const auto *row = matrix.sourceCompiled(*it, support.transposed) ?
+                                  matrix.row(*it, support.transposed) : nullptr;
+                bool consistent = false;
+                for (const auto &val : toDomain) {
+                    // values that were not part of the domains when the matrix was created use the predicate
+                    if (row != nullptr && matrix.targetCompiled(val, support.transposed) ?
+                        matrix.test(row, val, support.transposed) : reviser.satisfied(arc, *it, val)) {
+                        consistent = true;
+                        break;
+                    }
+                }
+
+                if (!consistent) {
+                    if (!removed) {
+                        trail.save(problem.arcSources[arcId], arc.from());
+                    }
+
+                    it = fromDomain.erase(it);
+                    removed = true;
+                } else {
+                    ++it;
+                }
+            }
+
+            return removed;
+        }
+    }
+
+    /**
+     * Creates a revision function that revises arcs of the given problem using their csp::util::ArcReviser
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+     * @param problem The CSP containing the arcs
+     * @param trail All domain modifications are recorded in the trail
+     * @return Callable that maps an arc index to true if the source domain of the arc was modified
+     */
+    template<typename VarPtr, typename TrailT>
+    auto predicateReviser(const Csp<VarPtr> &problem, TrailT &trail) {
+        Trail<VarPtr> *trailPtr = nullptr;
+        if constexpr (std::is_same_v<TrailT, Trail<VarPtr>>) {
+            trailPtr = &trail;
+        }
+
+        return [&problem, trailPtr](std::size_t arc) {
+            return problem.arcRevisers[arc](problem.arcs[arc], problem.arcSources[arc], trailPtr);
+        };
+    }
+
+    /**
+     * Creates a filter function that filters the global constraints of the given problem
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+     * @param problem The CSP containing the global constraints
+     * @param trail All domain modifications are recorded in the trail
+     * @return Callable that filters the global constraint with the given index, appends the positions of all modified
+     * variables to the given vector and returns false if the constraint cannot be satisfied
+     */
+    template<typename VarPtr, typename TrailT>
+    auto globalFilter(const Csp<VarPtr> &problem, TrailT &trail) {
+        Trail<VarPtr> *trailPtr = nullptr;
+        if constexpr (std::is_same_v<TrailT, Trail<VarPtr>>) {
+            trailPtr = &trail;
+        }
+
+        return [&problem, trailPtr](std::size_t constraint, std::vector<std::size_t> &changed) {
+            return problem.globalConstraints[constraint](trailPtr, changed);
+        };
+    }
+
+    /**
+     * Adds all arcs and global constraints to the queue that have to be revised after the value domain of the given
+     * variable was reduced
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @param problem The CSP containing the variable
+     * @param queue propagation queue of the problem
+     * @param varId index of the changed variable
+     */
     template<typename VarPtr>
-    bool removeInconsistent(const Arc<VarPtr> &arc) {
-        bool removed = false;
-        VarPtr from = arc.from();
-        VarPtr to = arc.to();
-        for (auto it = from->valueDomain().begin(); it != from->valueDomain().end();) {
-            bool consistent = false;
-            for (const auto &val : to->valueDomain()) {
-                if (arc.constraintSatisfied(*it, val)) {
-                    consistent = true;
-                    break;
+    void enqueueVariable(const Csp<VarPtr> &problem, ArcQueue &queue, std::size_t varId) {
+        for (std::size_t arc : problem.incomingArcs(varId)) {
+            queue.push(arc);
+        }
+
+        for (std::size_t constraint : problem.globalsOf(varId)) {
+            queue.push(problem.arcs.size() + constraint);
+        }
+    }
+
+    /**
+     * Processes the given queue until it is empty (main loop of the AC3-algorithm). Whenever a value domain
+     * is reduced, the incoming arcs and the global constraints of the respective variable are added to the queue.
+     * Queue entries [0, problem.arcs.size()) are arcs, all following entries are global constraints
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam Revise Callable that revises the arc with the given index (see csp::util::removeInconsistent)
+     * @tparam Filter Callable that filters the global constraint with the given index (see csp::util::globalFilter)
+     * @tparam StatsT Type of the statistics (csp::SolveStats or csp::util::NoStats)
+     * @param problem The CSP to be processed
+     * @param queue Initial queue of arc indices to be revised. Is empty when the function returns
+     * @param revise Revision function. Has to return true if the source domain of the arc was modified
+     * @param filter Filter function of the global constraints
+     * @param changed buffer for the positions of the variables modified by a global constraint. Can be reused
+     * between calls, so that filtering does not allocate
+     * @param stats revised arcs, filtered global constraints and pruned values are counted in stats
+     * @return True if arc consistency was obtained, false if not possible
+     */
+    template<typename VarPtr, typename Revise, typename Filter, typename StatsT = NoStats,
+            std::enable_if_t<std::is_invocable_r_v<bool, Revise, std::size_t>, int> = 0>
+    bool processArcs(const Csp<VarPtr> &problem, ArcQueue &queue, Revise &&revise, Filter &&filter,
+                     std::vector<std::size_t> &changed, StatsT &&stats = StatsT()) {
+        constexpr bool collectStats = type_traits::collects_stats<std::decay_t<StatsT>>::value;
+        while (!queue.empty()) {
+            const std::size_t current = queue.pop();
+            if (current >= problem.arcs.size()) {
+                const std::size_t constraint = current - problem.arcs.size();
+                const auto scope = problem.scope(constraint);
+                std::size_t before = 0;
+                if constexpr (collectStats) {
+                    for (std::size_t var : scope) {
+                        before += std::size(problem.variables[var]->valueDomain());
+                    }
+                }
+
+                changed.clear();
+                const bool consistent = filter(constraint, changed);
+                if constexpr (collectStats) {
+                    ++stats.globalsFiltered;
+                    for (std::size_t var : scope) {
+                        before -= std::size(problem.variables[var]->valueDomain());
+                    }
+
+                    stats.valuesPruned += before;
+                }
+
+                if (!consistent) {
+                    queue.clear();
+                    return false;
+                }
+
+                for (std::size_t pos : changed) {
+                    const std::size_t var = scope[pos];
+                    if (problem.variables[var]->valueDomain().empty()) {
+                        queue.clear();
+                        return false;
+                    }
+
+                    for (std::size_t arc : problem.incomingArcs(var)) {
+                        queue.push(arc);
+                    }
+
+                    for (std::size_t other : problem.globalsOf(var)) {
+                        if (other != constraint) {
+                            queue.push(problem.arcs.size() + other);
+                        }
+                    }
                 }
+
+                continue;
             }
 
-            if (!consistent) {
-                it = from->valueDomain().erase(it);
-                removed = true;
+            const std::size_t from = problem.arcSources[current];
+            bool revised;
+            if constexpr (collectStats) {
+                const auto &domain = problem.variables[from]->valueDomain();
+                const std::size_t before = std::size(domain);
+                revised = revise(current);
+                ++stats.arcsRevised;
+                stats.valuesPruned += before - std::size(domain);
             } else {
-                ++it;
+                revised = revise(current);
+            }
+
+            if (revised) {
+                if (problem.variables[from]->valueDomain().empty()) {
+                    queue.clear();
+                    return false;
+                }
+
+                for (std::size_t arc : problem.incomingArcs(from)) {
+                    if (problem.arcSources[arc] != problem.arcTargets[current]) {
+                        queue.push(arc);
+                    }
+                }
+
+                for (std::size_t constraint : problem.globalsOf(from)) {
+                    queue.push(problem.arcs.size() + constraint);
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Processes the given queue until it is empty (main loop of the AC3-algorithm). Whenever a value domain
+     * is reduced, the incoming arcs and global constraints of the respective variable are added to the queue. Arcs are
+     * revised using their csp::SupportMatrix if the CSP was created with csp::ConstraintMode::Matrix and using their
+     * csp::util::ArcReviser otherwise
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+     * @tparam StatsT Type of the statistics (csp::SolveStats or csp::util::NoStats)
+     * @param problem The CSP to be processed
+     * @param queue Initial queue of arc indices to be revised. Is empty when the function returns
+     * @param trail All domain modifications are recorded in the trail
+     * @param stats revised arcs and pruned values are counted in stats
+     * @return True if arc consistency was obtained, false if not possible
+     */
+    template<typename VarPtr, typename TrailT, typename StatsT = NoStats,
+            std::enable_if_t<!std::is_invocable_v<TrailT, std::size_t>, int> = 0>
+    bool processArcs(const Csp<VarPtr> &problem, ArcQueue &queue, TrailT &trail, StatsT &&stats = StatsT()) {
+        std::vector<std::size_t> changed;
+        if constexpr (std::is_integral_v<typename Csp<VarPtr>::VarT::ValueT>) {
+            if (!problem.arcSupports.empty()) {
+                return processArcs(problem, queue, [&problem, &trail](std::size_t arc) {
+                    return removeInconsistent(problem, arc, trail);
+                }, globalFilter(problem, trail), changed, std::forward<StatsT>(stats));
             }
         }
 
-        return removed;
+        return processArcs(problem, queue, predicateReviser(problem, trail), globalFilter(problem, trail), changed,
+                           std::forward<StatsT>(stats));
+    }
+
+    /**
+     * Obtains arc consistency in a CSP using the AC3-algorithm
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+     * @tparam StatsT Type of the statistics (csp::SolveStats or csp::util::NoStats)
+     * @param problem The CSP to be processed
+     * @param queue Empty arc queue of the problem. Is reused to avoid allocations
+     * @param trail All domain modifications are recorded in the trail
+     * @param stats statistics of the run are added to stats
+     * @return True if arc consistency was obtained, false if not possible
+     */
+    template<typename VarPtr, typename TrailT, typename StatsT = NoStats>
+    bool ac3(Csp<VarPtr> &problem, ArcQueue &queue, TrailT &trail, StatsT &&stats = StatsT()) {
+        if constexpr (type_traits::collects_stats<std::decay_t<StatsT>>::value) {
+            ++stats.ac3Calls;
+        }
+
+        queue.pushAll();
+        return processArcs(problem, queue, trail, std::forward<StatsT>(stats));
+    }
+
+    /**
+     * Obtains arc consistency in a CSP using the AC3-algorithm
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+     * @param problem The CSP to be processed
+     * @param trail All domain modifications are recorded in the trail
+     * @return True if arc consistency was obtained, false if not possible
+     */
+    template<typename VarPtr, typename TrailT>
+    bool ac3(Csp<VarPtr> &problem, TrailT &trail) {
+        ArcQueue queue(problem.queueSize());
+        return ac3(problem, queue, trail);
     }
 
     /**
@@ -58,24 +376,65 @@ namespace csp::util {
      */
     template<typename VarPtr>
     bool ac3(Csp<VarPtr> &problem) {
-        using ArcT = typename Csp<VarPtr>::ArcT;
-        typename Csp<VarPtr>::ArcListT arcs = problem.arcs;
-        while (!arcs.empty()) {
-            const ArcT current = arcs.front();
-            arcs.pop_front();
-            if(removeInconsistent(current)) {
-                if (current.from()->valueDomain().empty()) {
-                    return false;
-                }
+        NoTrail trail;
+        return ac3(problem, trail);
+    }
 
-                auto it = problem.incomingNeighbours.find(current.from());
-                assert(it != problem.incomingNeighbours.end());
-                std::copy_if(it->second.begin(), it->second.end(), std::back_inserter(arcs),
-                        [&current](const auto &arc) {return arc.from() != current.to();});
-            }
+    /**
+     * Restores arc consistency in a CSP that was arc consistent before the value domains of the given variables were
+     * reduced. Only the incoming arcs of the changed variables are initially revised.
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam VarContainer Container-Type containing pointer-types of the changed variables
+     * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+     * @param problem The CSP to be processed
+     * @param changedVars Variables whose value domains were reduced since arc consistency was last obtained
+     * @param queue Empty arc queue of the problem. Is reused to avoid allocations
+     * @param trail All domain modifications are recorded in the trail
+     * @return True if arc consistency was obtained, false if not possible
+     * @note If the CSP was not arc consistent before, the result is not necessarily arc consistent. Use
+     * csp::util::ac3 in that case
+     */
+    template<typename VarPtr, typename VarContainer, typename TrailT>
+    bool ac3From(Csp<VarPtr> &problem, const VarContainer &changedVars, ArcQueue &queue, TrailT &trail) {
+        for (const auto &var : changedVars) {
+            auto it = problem.varIds.find(var);
+            assert(it != problem.varIds.end());
+            enqueueVariable(problem, queue, it->second);
         }
 
-        return true;
+        return processArcs(problem, queue, trail);
+    }
+
+    /**
+     * Restores arc consistency in a CSP that was arc consistent before the value domains of the given variables were
+     * reduced. Only the incoming arcs of the changed variables are initially revised.
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam VarContainer Container-Type containing pointer-types of the changed variables
+     * @tparam TrailT Type of the undo log (csp::util::Trail or csp::util::NoTrail)
+     * @param problem The CSP to be processed
+     * @param changedVars Variables whose value domains were reduced since arc consistency was last obtained
+     * @param trail All domain modifications are recorded in the trail
+     * @return True if arc consistency was obtained, false if not possible
+     */
+    template<typename VarPtr, typename VarContainer, typename TrailT>
+    bool ac3From(Csp<VarPtr> &problem, const VarContainer &changedVars, TrailT &trail) {
+        ArcQueue queue(problem.queueSize());
+        return ac3From(problem, changedVars, queue, trail);
+    }
+
+    /**
+     * Restores arc consistency in a CSP that was arc consistent before the value domains of the given variables were
+     * reduced. Only the incoming arcs of the changed variables are initially revised.
+     * @tparam VarPtr Pointer-type to a type derived from csp::Variable
+     * @tparam VarContainer Container-Type containing pointer-types of the changed variables
+     * @param problem The CSP to be processed
+     * @param changedVars Variables whose value domains were reduced since arc consistency was last obtained
+     * @return True if arc consistency was obtained, false if not possible
+     */
+    template<typename VarPtr, typename VarContainer>
+    bool ac3From(Csp<VarPtr> &problem, const VarContainer &changedVars) {
+        NoTrail trail;
+        return ac3From(problem, changedVars, trail);
     }
 
     template<typename VarT>